@@ -0,0 +1,60 @@
+#!/bin/bash
+
+################################################################################
+# The MIT License
+#
+# Copyright (c) 2020 António Sarmento - https://github.com/Keyaku
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+#  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+#  copies of the Software, and to permit persons to whom the Software is
+#  furnished to do so, subject to the following conditions:
+#
+#  The above copyright notice and this permission notice shall be included in
+#  all copies or substantial portions of the Software.
+#
+#  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+#  THE SOFTWARE.
+################################################################################
+
+# Prints a per-phase speedup table out of two bench.sh reports.
+# Usage: bench-compare.sh baseline.json candidate.json
+# Speedups compare medians: above 1.00x means the candidate is faster.
+
+if [ $# -ne 2 ]; then
+	echo "Usage: $(basename "$0") baseline.json candidate.json"
+	exit 2
+fi
+
+# One "input phase median" line per phase of every result
+function medians {
+	awk '
+	/"input": / {
+		match($0, /"input": "[^"]*"/)
+		input = substr($0, RSTART + 10, RLENGTH - 11)
+		n = split("parse build solve output total", phase, " ")
+		for (p = 1; p <= n; p++) {
+			if (match($0, "\"" phase[p] "\": {[^}]*\"median\": [0-9.]+")) {
+				field = substr($0, RSTART, RLENGTH)
+				sub(/.*"median": /, "", field)
+				print input, phase[p], field
+			}
+		}
+	}' "$1"
+}
+
+paste -d ' ' <(medians "$1") <(medians "$2") | awk -v a="$(basename "$1" .json)" -v b="$(basename "$2" .json)" '
+BEGIN { printf "%-32s %-8s %12s %12s %9s\n", "input", "phase", a " (s)", b " (s)", "speedup" }
+{
+	if ($1 != $4 || $2 != $5) { print "Reports do not cover the same inputs." > "/dev/stderr"; exit 1 }
+	input = $1; if (length(input) > 32) { input = "..." substr(input, length(input) - 28) }
+	speedup = ($6 > 0) ? sprintf("%.2fx", $3 / $6) : "-"
+	printf "%-32s %-8s %12.6f %12.6f %9s\n", input, $2, $3, $6, speedup
+}'
@@ -0,0 +1,241 @@
+#!/bin/bash
+
+################################################################################
+# The MIT License
+#
+# Copyright (c) 2020 António Sarmento - https://github.com/Keyaku
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+#  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+#  copies of the Software, and to permit persons to whom the Software is
+#  furnished to do so, subject to the following conditions:
+#
+#  The above copyright notice and this permission notice shall be included in
+#  all copies or substantial portions of the Software.
+#
+#  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+#  THE SOFTWARE.
+################################################################################
+
+# =========== CONSTANTS ===========
+readonly ScriptName="$0"
+readonly DIR_common="$(cd "$(dirname "$(readlink -f "$0")")" && pwd)"
+
+# String Arrays
+readonly usage_content=( "Usage: $(basename $ScriptName) [OPTIONS] -f input..."
+"HELP:
+	-h | --help : Shows this message
+"
+"FILES & DIRECTORIES:
+	-d : Benchmark every input in a directory
+	-e : Specify executable (built with BUILD=time). Defaults to bld/proj
+	-f : Specify an input. May be given more than once
+	-o : Write the JSON report to a file instead of stdout
+"
+"OPTIONS:
+	-c | --compile [flags] : Runs Makefile with BUILD=time and the given flags first
+	-n | --repetitions N   : Timed runs per input (default: 10)
+	-w | --warmup N        : Untimed runs per input (default: 1)
+"
+)
+
+# Loading external symbols
+source "$DIR_common/_base.env"
+source "$DIR_common/_test.env"
+
+# Phases reported by common/src/Bench.h
+readonly Phases=(parse build solve output)
+
+# =========== VARIABLES ===========
+FILE_inputs=()
+FILE_report=""
+EXEC_prog="$(pwd)/bld/proj"
+
+# Options
+BOOL_compile=false
+NUM_reps=10
+NUM_warmup=1
+
+# =========== FUNCTIONS ===========
+function usage {
+	for i in `seq 0 ${#usage_content[@]}`; do
+		echo -e "${usage_content[i]}"
+	done
+	exit $RET_usage
+}
+
+function parse_args {
+	while [ $# -gt 0 ]; do
+		case $1 in
+			# FILES & DIRECTORIES
+			-d )
+				shift
+				FILE_inputs+=($(find "$1" -type f -iname "*.${EXT_input}" | sort))
+				;;
+			-e )
+				shift
+				EXEC_prog="$(get_absolute_dir $(dirname $1))/$(basename $1)"
+				;;
+			-f )
+				shift
+				FILE_inputs+=("$1")
+				;;
+			-o )
+				shift
+				FILE_report="$1"
+				;;
+
+			# OPTIONS
+			-c | --compile )
+				BOOL_compile=true
+				shift
+				if [ $# -eq 0 ]; then continue; fi
+				if [ ${1:0:1} = "-" ]; then continue; fi
+				cflags="$1"
+				;;
+			-n | --repetitions )
+				shift
+				NUM_reps=$1
+				;;
+			-w | --warmup )
+				shift
+				NUM_warmup=$1
+				;;
+
+			# HELP
+			-h | --help )
+				usage
+				;;
+			* ) printf "Unknown argument. \"$1\"\n"
+				;;
+		esac
+		shift
+	done
+
+	return $RET_success
+}
+
+function check_env {
+	if [ ${#FILE_inputs[@]} -eq 0 ]; then
+		print_error "No inputs given."
+		return $RET_error
+	fi
+	if [ "$NUM_reps" -lt 1 ] 2>/dev/null; then
+		print_error "At least one repetition is needed."
+		return $RET_error
+	fi
+	if [ ! -x "$EXEC_prog" ]; then
+		print_error "$EXEC_prog is not an executable."
+		return $RET_error
+	fi
+}
+
+function compile {
+	if $BOOL_compile; then
+		make BUILD=time ${cflags} >&2
+		return $?
+	fi
+}
+
+# Runs the solver once; prints its Bench.h line
+function run_once {
+	# $1 : input file
+	"$EXEC_prog" < "$1" 2>&1 > /dev/null | grep '^{"parse"' | tail -n 1
+}
+
+# Turns the Bench.h lines on stdin into min, median & p95 for each phase.
+# Counters are the same on every run, so the last run's are kept as they are
+function summarize {
+	awk -v phases="${Phases[*]}" '
+	function sort(a, n,    i, j, t) {
+		for (i = 2; i <= n; i++) {
+			t = a[i]
+			for (j = i - 1; j > 0 && a[j] > t; j--) { a[j+1] = a[j] }
+			a[j+1] = t
+		}
+	}
+	function stats(a, n,    i, p95) {
+		sort(a, n)
+		p95 = int(0.95 * n); if (p95 < 0.95 * n) { p95++ }
+		return sprintf("{\"min\": %.6f, \"median\": %.6f, \"p95\": %.6f}",
+			a[1], (n % 2) ? a[(n+1)/2] : (a[n/2] + a[n/2+1]) / 2, a[p95])
+	}
+	BEGIN {
+		np = split(phases, name, " ")
+		for (p = 1; p <= np; p++) { is_phase[name[p]] = 1 }
+	}
+	NF > 0 {
+		gsub(/[{}",:]/, " ")
+		n++
+		total[n] = 0
+		for (i = 1; i < NF; i += 2) {
+			if ($i in is_phase) { value[$i, n] = $(i+1); total[n] += $(i+1) }
+			else { counters = counters sprintf(", \"%s\": %s", $i, $(i+1)) }
+		}
+		last = counters; counters = ""
+	}
+	END {
+		printf "{"
+		for (p = 1; p <= np; p++) {
+			for (i = 1; i <= n; i++) { col[i] = value[name[p], i] + 0 }
+			printf "\"%s\": %s, ", name[p], stats(col, n)
+		}
+		printf "\"total\": %s}", stats(total, n)
+		if (last != "") { printf ", \"counters\": {%s}", substr(last, 3) }
+	}'
+}
+
+function bench_input {
+	# $1 : input file
+	local lines=""
+
+	for i in $(seq 1 $NUM_warmup); do
+		run_once "$1" > /dev/null
+	done
+	for i in $(seq 1 $NUM_reps); do
+		lines+="$(run_once "$1")"$'\n'
+	done
+
+	if [ -z "$(echo -n "$lines" | tr -d '\n')" ]; then
+		print_error "$EXEC_prog printed no timings. Was it built with BUILD=time?"
+		return $RET_error
+	fi
+
+	printf '{"input": "%s", "warmup": %d, "repetitions": %d, "phases": %s}' \
+		"$1" $NUM_warmup $NUM_reps "$(echo -n "$lines" | summarize)"
+}
+
+function bench_list {
+	local sep=""
+
+	printf '{"executable": "%s", "results": [' "$EXEC_prog"
+	for input in "${FILE_inputs[@]}"; do
+		local result
+		result="$(bench_input "$input")" || return $RET_error
+		printf '%s\n  %s' "$sep" "$result"
+		sep=","
+	done
+	printf '\n]}\n'
+}
+
+function main {
+	parse_args "$@"
+	compile || exit $RET_error
+	check_env || usage
+
+	if [ "$FILE_report" ]; then
+		bench_list > "$FILE_report"
+	else
+		bench_list
+	fi
+}
+
+# Script starts HERE
+main "$@"
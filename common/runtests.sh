@@ -46,6 +46,12 @@ readonly usage_content=( "Usage: $(basename $ScriptName)"
 	-s | --single          : Stops on the first failure
 	-t | --time            : Use system timer when running tests
 "
+"PERFORMANCE:
+	-j | --jobs [N]       : Runs N tests at once (default: every core)
+	-r | --report FILE    : Writes each test's wall, user & sys time and peak RSS to a CSV
+	-b | --baseline FILE  : Fails tests that got slower or bigger than in an earlier report
+	--threshold PCT       : How much worse than the baseline is a regression (default: 20)
+"
 )
 
 # Loading external symbols
@@ -55,13 +61,21 @@ source "$DIR_repo/common/_test.env"
 # Files & Directories
 readonly DIR_current="$(pwd)"
 
+# Differences smaller than these are noise, whatever the threshold says
+readonly NOISE_wall=0.05   # seconds
+readonly NOISE_rss=1024    # KiB
+
 # =========== VARIABLES ===========
 FILE_tests=()
+FILE_report=""
+FILE_baseline=""
 
 # Options
 BOOL_compile=false
 BOOL_quiet=false
 BOOL_singleFail=false
+NUM_jobs=1
+NUM_threshold=20
 
 # =========== FUNCTIONS ===========
 function usage {
@@ -115,6 +129,27 @@ function parse_args {
 				useTimer="time"
 				;;
 
+			# PERFORMANCE
+			-j | --jobs )
+				NUM_jobs="$(nproc)"
+				if [ $# -gt 1 ] && [ "${2:0:1}" != "-" ]; then
+					shift
+					NUM_jobs=$1
+				fi
+				;;
+			-r | --report )
+				shift
+				FILE_report="$1"
+				;;
+			-b | --baseline )
+				shift
+				FILE_baseline="$1"
+				;;
+			--threshold )
+				shift
+				NUM_threshold=$1
+				;;
+
 			# HELP
 			-h | --help )
 				usage
@@ -135,7 +170,20 @@ function set_defaults {
 		DIR_tests="$DIR_script"
 	fi
 
-	EXEC_prog="$DIR_project/bld/proj"
+	if [ -z "$EXEC_prog" ]; then
+		EXEC_prog="$DIR_project/bld/proj"
+	fi
+
+	# Measuring: asatime (make tools) if built, GNU time if installed, else bash's time
+	if [ "$FILE_report" -o "$FILE_baseline" ]; then
+		if [ -x "$(dirname "$EXEC_prog")/asatime" ]; then
+			useMeter="$(dirname "$EXEC_prog")/asatime"
+		elif [ -x /usr/bin/time ]; then
+			useMeter="/usr/bin/time"
+		else
+			useMeter="time"
+		fi
+	fi
 }
 
 function check_env {
@@ -144,6 +192,14 @@ function check_env {
 		print_error "valgrind is not installed."
 		return $RET_error
 	fi
+	if [ "$FILE_baseline" -a ! -f "$FILE_baseline" ]; then
+		print_error "Baseline $FILE_baseline does not exist."
+		return $RET_error
+	fi
+	if ! [ "$NUM_jobs" -ge 1 ] 2>/dev/null; then
+		print_error "Number of jobs must be a positive integer."
+		return $RET_error
+	fi
 }
 
 function compile {
@@ -159,55 +215,149 @@ function compile {
 	fi
 }
 
+# Runs one test, leaving its output in .res, its exit code in .status and,
+# when measuring, "wall,user,sys,rss" in .time
+function run_test {
+	# $1 : test input
+	local test_base="${1%.*}"
+	local test_outhyp="$test_base.${EXT_outhyp}"
+
+	if [ "$useValgrind" ]; then
+		$useValgrind "$EXEC_prog" < "$1" > "$test_outhyp"
+	elif [ "$useMeter" = "time" ]; then
+		local TIMEFORMAT="%3R,%3U,%3S,"
+		{ time "$EXEC_prog" < "$1" > "$test_outhyp" 2>&3; } 3>&2 2> "$test_base.time"
+	elif [ "$useMeter" = "/usr/bin/time" ]; then
+		/usr/bin/time -f "%e,%U,%S,%M" -o "$test_base.time" "$EXEC_prog" < "$1" > "$test_outhyp"
+	elif [ "$useMeter" ]; then
+		"$useMeter" "$test_base.time" "$EXEC_prog" < "$1" > "$test_outhyp"
+	else
+		$useTimer "$EXEC_prog" < "$1" > "$test_outhyp"
+	fi
+	echo $? > "$test_base.status"
+}
+
+# Runs every test, at most NUM_jobs at a time
+function run_all {
+	local running=0
+
+	for test_input in "${FILE_tests[@]}"; do
+		if [ $running -ge $NUM_jobs ]; then
+			wait -n
+			running=$(($running - 1))
+		fi
+		run_test "$test_input" &
+		running=$(($running + 1))
+	done
+	wait
+}
+
+# Checks a test that already ran. Returns 0 on success, 1 on failure, 2 if there
+# was no expected output and 3 if the program failed
+function check_test {
+	# $1 : test input
+	local test_base="${1%.*}"
+	local test_result="$test_base.diff"
+	local test_outhyp="$test_base.${EXT_outhyp}"
+	local test_output="$test_base.${EXT_output}"
+	local status=pass
+	local retval=0
+
+	for ext in ${EXT_output[@]}; do
+		test_output="$test_base.${ext}"
+		test -f "$test_output" && break
+	done
+
+	printf "Testing $(basename "$1")... "
+
+	if [ "$(cat "$test_base.status")" -ne 0 ]; then
+		print_error "Failed execution."
+		status=crash
+		retval=3
+	elif [ -s "$test_output" ]; then
+		diff "$test_outhyp" "$test_output" > "$test_result"
+
+		# Act accordingly
+		if [ -s "$test_result" ]; then
+			print_failure "See file $test_result\n"
+			status=fail
+			retval=1
+		else
+			println "${Gre}√${RCol}"
+			rm -f "$test_result" "$test_outhyp"
+		fi
+	else
+		println "${Yel}?${RCol}"
+		status=odd
+		retval=2
+	fi
+
+	if [ "$FILE_report" ]; then
+		echo "$1,$status,$(cat "$test_base.time" 2>/dev/null)" >> "$FILE_report"
+	fi
+	rm -f "$test_base.status" "$test_base.time"
+	return $retval
+}
+
+# Compares the report against the baseline; prints & counts the regressions
+function check_baseline {
+	# $1 : report of this run
+	awk -F, -v threshold="$NUM_threshold" -v noise_wall="$NOISE_wall" -v noise_rss="$NOISE_rss" '
+	function worse(now, before, noise) {
+		return now - before > noise && now > before * (1 + threshold / 100)
+	}
+	function growth(now, before) {
+		return before > 0 ? sprintf("+%.0f%%", (now / before - 1) * 100) : "new"
+	}
+	FNR == 1 { next }
+	NR == FNR { wall[$1] = $3; rss[$1] = $6; next }
+	!($1 in wall) { next }
+	{
+		if (worse($3, wall[$1], noise_wall)) {
+			printf "Regression: %s took %.3fs, was %.3fs (%s)\n", $1, $3, wall[$1], growth($3, wall[$1]) > "/dev/stderr"
+			count++
+		}
+		if ($6 != "" && rss[$1] != "" && worse($6, rss[$1], noise_rss)) {
+			printf "Regression: %s peaked at %d KiB, was %d KiB (%s)\n", $1, $6, rss[$1], growth($6, rss[$1]) > "/dev/stderr"
+			count++
+		}
+	}
+	END { exit count > 255 ? 255 : count }' "$FILE_baseline" "$1"
+}
+
 # Target functionality
 function test_list {
 	local tested_count=0
 	local fail_count=0
 	local odd_count=0
+	local regress_count=0
+	local report="$FILE_report"
+
+	# The baseline needs a report, even if nobody asked to keep one
+	if [ "$FILE_baseline" -a -z "$FILE_report" ]; then
+		FILE_report="$(mktemp)"
+	fi
+	if [ "$FILE_report" ]; then
+		echo "test,status,wall_s,user_s,sys_s,max_rss_kb" > "$FILE_report"
+	fi
 
 	print_progress "\nBegin testing..."
-	for test_input in "${FILE_tests[@]}"; do
-		test_input="${test_input/$DIR_project\/}"
-		local test_result="${test_input%.*}.diff"
-		local test_outhyp="${test_input%.*}.${EXT_outhyp}"
-		local test_output="${test_input%.*}.${EXT_output}"
-
-		for ext in ${EXT_output[@]}; do
-			test_output="${test_input%.*}.${ext}"
-			test -f "$test_output" && break
-		done
-
-		# Running program
-		local test_name="$(basename "$test_input")"
-		printf "Testing $test_name... "
-
-		if [ "$useValgrind" ]; then
-			$useValgrind "$EXEC_prog" < "$test_input" > "$test_outhyp"
-		else
-			$useTimer "$EXEC_prog" < "$test_input" > "$test_outhyp"
-		fi
+	FILE_tests=("${FILE_tests[@]/$DIR_project\/}")
+	if [ $NUM_jobs -gt 1 ]; then
+		run_all
+	fi
 
-		if [ $? -ne 0 ]; then
-			print_error "Failed execution."
-			return $RET_error
+	for test_input in "${FILE_tests[@]}"; do
+		if [ $NUM_jobs -eq 1 ]; then
+			run_test "$test_input"
 		fi
 
-		# Comparing results
-		if [ -s "$test_output" ]; then
-			diff "$test_outhyp" "$test_output" > "$test_result"
-
-			# Act accordingly
-			if [ -s "$test_result" ]; then
-				print_failure "See file $test_result\n"
-				fail_count=$(($fail_count + 1))
-			else
-				println "${Gre}√${RCol}"
-				rm -f "$test_result" "$test_outhyp"
-			fi
-		else
-			println "${Yel}?${RCol}"
-			odd_count=$(($odd_count + 1))
-		fi
+		check_test "$test_input"
+		case $? in
+			1 ) fail_count=$(($fail_count + 1)) ;;
+			2 ) odd_count=$(($odd_count + 1)) ;;
+			3 ) return $RET_error ;;
+		esac
 
 		tested_count=$(($tested_count + 1))
 
@@ -216,13 +366,24 @@ function test_list {
 		fi
 	done
 
-	local total_count=$(($fail_count + $odd_count))
+	if [ "$FILE_baseline" ]; then
+		check_baseline "$FILE_report"
+		regress_count=$?
+		if [ -z "$report" ]; then
+			rm -f "$FILE_report"
+		fi
+	fi
+
+	local total_count=$(($fail_count + $odd_count + $regress_count))
 
 	if [ $fail_count -gt 0 ]; then
 		print_failure "Failed $fail_count / $tested_count tests (${#FILE_tests[@]} in total)."
 	elif [ $odd_count -gt 0 ]; then
 		println "Problems occurred in $odd_count / $tested_count tests (${#FILE_tests[@]} in total)."
 	fi
+	if [ $regress_count -gt 0 ]; then
+		print_failure "$regress_count regressions against $FILE_baseline (threshold: ${NUM_threshold}%%)."
+	fi
 
 	return $total_count
 }
@@ -236,7 +397,10 @@ function get_test_list {
 }
 
 function cleanup {
-	: # Nothing to clean
+	# Leftovers of tests that ran but were never checked
+	for test_input in "${FILE_tests[@]}"; do
+		rm -f "${test_input%.*}.status" "${test_input%.*}.time"
+	done
 }
 
 function main {
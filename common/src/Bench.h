@@ -0,0 +1,123 @@
+#ifndef ASA_BENCH_H
+#define ASA_BENCH_H
+
+/*
+** Per-phase wall-clock timers and event counters for solvers built with
+** ASA_BENCHMARK (`make BUILD=time`). A solver marks where each phase begins
+** with Bench_Phase() and counts what its hot loops do with Bench_Count(),
+** Bench_Add() and Bench_Enter()/Bench_Leave() (around recursive calls).
+** The phase running at exit is closed after the output buffer is written,
+** and everything goes to stderr as one JSON line; counters never touched are
+** left out:
+**   {"parse": 0.012, "build": 0.003, "solve": 0.250, "output": 0.001, "bfs_passes": 42}
+** common/bench.sh runs a solver repeatedly and summarizes those lines.
+** Without ASA_BENCHMARK every macro compiles to nothing.
+*/
+enum bench_phase {
+	BENCH_PARSE,   /* Reading & tokenizing input */
+	BENCH_BUILD,   /* Laying out the graph */
+	BENCH_SOLVE,   /* The algorithm itself */
+	BENCH_OUTPUT,  /* Printing (and writing) results */
+	BENCH_NR_PHASES
+};
+
+enum bench_counter {
+	BENCH_BFS_PASSES,        /* Breadth-first searches started */
+	BENCH_AUGMENTING_PATHS,  /* Paths that carried flow */
+	BENCH_EDGES_SCANNED,     /* Adjacencies looked at */
+	BENCH_UF_FINDS,          /* Union-find lookups */
+	BENCH_UF_COMPRESSIONS,   /* Parent links shortened by those lookups */
+	BENCH_DFS_CALLS,         /* Recursive calls (see Bench_Enter) */
+	BENCH_DFS_DEPTH,         /* Deepest recursion reached */
+	BENCH_NR_COUNTERS
+};
+
+#ifdef ASA_BENCHMARK
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+typedef struct bench {
+	double elapsed[BENCH_NR_PHASES];  /* elapsed[phase] = seconds */
+	double since;                     /* When the current phase began */
+	int phase;                        /* Current phase, -1 before the first */
+	long count[BENCH_NR_COUNTERS];    /* count[counter] = events */
+	long depth;                       /* Current recursion depth */
+} Bench;
+
+Bench Bench_state = { { 0 }, 0, -1, { 0 }, 0 };
+
+const char *Bench_counter_names[BENCH_NR_COUNTERS] = {
+	"bfs_passes", "augmenting_paths", "edges_scanned",
+	"uf_finds", "uf_compressions", "dfs_calls", "dfs_depth"
+};
+
+double Bench_Now(void)
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+/* Closes the current phase, if any */
+void Bench_Stop(void)
+{
+	if (Bench_state.phase >= 0) {
+		Bench_state.elapsed[Bench_state.phase] += Bench_Now() - Bench_state.since;
+		Bench_state.phase = -1;
+	}
+}
+
+void Bench_Report(void)
+{
+	int i;
+
+	fflush(stdout);
+	Bench_Stop();
+	fprintf(stderr, "{\"parse\": %.6f, \"build\": %.6f, \"solve\": %.6f, \"output\": %.6f",
+		Bench_state.elapsed[BENCH_PARSE], Bench_state.elapsed[BENCH_BUILD],
+		Bench_state.elapsed[BENCH_SOLVE], Bench_state.elapsed[BENCH_OUTPUT]);
+	for (i = 0; i < BENCH_NR_COUNTERS; i++) {
+		if (Bench_state.count[i] > 0) {
+			fprintf(stderr, ", \"%s\": %ld", Bench_counter_names[i], Bench_state.count[i]);
+		}
+	}
+	fprintf(stderr, "}\n");
+}
+
+/* Starts phase, closing the previous one. The first call registers the report,
+** so it runs after anything registered later (such as Output_Stdout's write). */
+void Bench_Start(int phase)
+{
+	static int registered = 0;
+	if (!registered) {
+		registered = 1;
+		atexit(Bench_Report);
+	}
+	Bench_Stop();
+	Bench_state.phase = phase;
+	Bench_state.since = Bench_Now();
+}
+
+/* One more recursive call, one level deeper */
+void Bench_Enter(void)
+{
+	Bench_state.count[BENCH_DFS_CALLS]++;
+	if (++Bench_state.depth > Bench_state.count[BENCH_DFS_DEPTH]) {
+		Bench_state.count[BENCH_DFS_DEPTH] = Bench_state.depth;
+	}
+}
+
+#define Bench_Phase(phase) Bench_Start(phase)
+#define Bench_Add(counter, n) (Bench_state.count[counter] += (n))
+#define Bench_Count(counter) Bench_Add(counter, 1)
+#define Bench_Leave() (Bench_state.depth--)
+#else
+#define Bench_Phase(phase) ((void) 0)
+#define Bench_Add(counter, n) ((void) 0)
+#define Bench_Count(counter) ((void) 0)
+#define Bench_Enter() ((void) 0)
+#define Bench_Leave() ((void) 0)
+#endif
+
+#endif
@@ -0,0 +1,202 @@
+#ifndef ASA_CSR_H
+#define ASA_CSR_H
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "GraphFile.h"
+
+/*
+** A compressed sparse row graph.
+** The edges leaving Vertex u are target[offset[u]] .. target[offset[u+1]-1],
+** contiguous in memory. Edges are collected with CSR_Add, then CSR_Build
+** places them with a two-pass counting sort in O(V+E): one pass counts each
+** source's out-degree, the other scatters the edges. Every adjacency keeps
+** the order in which its edges were added.
+*/
+typedef struct csr {
+	int nr_vertices;  /* Vertex ids go from 0 to nr_vertices */
+	int nr_edges;
+
+	int *offset;      /* offset[Vertex] = Edge, nr_vertices+2 entries */
+	int *target;      /* target[Edge]   = Vertex */
+	int *weight;      /* weight[Edge]   = int; NULL if unweighted */
+
+	/* Edges collected until CSR_Build */
+	int *src, *dst, *w;
+	int size, capacity;
+
+	int weighted;
+	int mapped;       /* offset, target & weight live in a GraphFile */
+} CSR;
+
+/* Prepares an empty graph over ids [0, num_v]; num_e is only a size hint */
+void CSR_New(CSR *g, int num_v, int num_e, int weighted)
+{
+	memset(g, 0, sizeof(*g));
+	g->nr_vertices = num_v;
+	g->capacity = num_e > 0 ? num_e : 1;
+	g->weighted = weighted;
+}
+
+/* Makes room for at least capacity collected edges */
+void CSR_Reserve(CSR *g, int capacity)
+{
+	if (g->src != NULL && capacity <= g->capacity) { return; }
+	if (capacity > g->capacity) { g->capacity = capacity; }
+
+	g->src = (int*) realloc(g->src, g->capacity * sizeof(*g->src));
+	g->dst = (int*) realloc(g->dst, g->capacity * sizeof(*g->dst));
+	if (g->weighted) { g->w = (int*) realloc(g->w, g->capacity * sizeof(*g->w)); }
+}
+
+void CSR_Add(CSR *g, int u, int v, int w)
+{
+	if (g->src == NULL || g->size == g->capacity) {
+		CSR_Reserve(g, g->src != NULL ? 2 * g->capacity : g->capacity);
+	}
+
+	g->src[g->size] = u;
+	g->dst[g->size] = v;
+	if (g->weighted) { g->w[g->size] = w; }
+	g->size++;
+}
+
+/* Drops repeated (u, v) edges, keeping the first of each. O(V+E). */
+void CSR_Dedup(CSR *g)
+{
+	int *seen = (int*) malloc((g->nr_vertices+1) * sizeof(*seen));
+	int u, e = 0;
+
+	for (u = 0; u <= g->nr_vertices; u++) { seen[u] = -1; }
+
+	for (u = 0; u <= g->nr_vertices; u++) {
+		int adj, begin = g->offset[u], end = g->offset[u+1];
+
+		g->offset[u] = e;
+		for (adj = begin; adj < end; adj++) {
+			int v = g->target[adj];
+			if (seen[v] == u) { continue; }
+			seen[v] = u;
+
+			g->target[e] = v;
+			if (g->weight) { g->weight[e] = g->weight[adj]; }
+			e++;
+		}
+	}
+	g->offset[g->nr_vertices+1] = g->nr_edges = e;
+
+	free(seen);
+}
+
+/* Turns the collected edges into the CSR arrays */
+void CSR_Build(CSR *g, int dedup)
+{
+	int i, num_ids = g->nr_vertices + 1;
+
+	g->nr_edges = g->size;
+	g->offset = (int*) calloc(num_ids + 1, sizeof(*g->offset));
+	g->target = (int*) malloc((g->size + 1) * sizeof(*g->target));
+	g->weight = g->weighted ? (int*) malloc((g->size + 1) * sizeof(*g->weight)) : NULL;
+
+	/* 1st pass: out-degrees, then their prefix sums */
+	for (i = 0; i < g->size; i++) { g->offset[g->src[i]+1]++; }
+	for (i = 0; i < num_ids; i++) { g->offset[i+1] += g->offset[i]; }
+
+	/* 2nd pass: scattering (offset[u] slides to offset[u+1] along the way) */
+	for (i = 0; i < g->size; i++) {
+		int e = g->offset[g->src[i]]++;
+		g->target[e] = g->dst[i];
+		if (g->weight) { g->weight[e] = g->w[i]; }
+	}
+	for (i = num_ids; i > 0; i--) { g->offset[i] = g->offset[i-1]; }
+	g->offset[0] = 0;
+
+	free(g->src); g->src = NULL;
+	free(g->dst); g->dst = NULL;
+	free(g->w);   g->w   = NULL;
+	g->size = g->capacity = 0;
+
+	if (dedup) { CSR_Dedup(g); }
+}
+
+/* Orders the collected edges by target, with a stable counting sort in O(V+E).
+** CSR_Build's own pass by source is stable too, so building right after leaves
+** every adjacency sorted: the two make an LSD radix sort on (source, target). */
+void CSR_SortTargets(CSR *g)
+{
+	int i, num_ids = g->nr_vertices + 1;
+	int *count = (int*) calloc(num_ids + 1, sizeof(*count));
+	int *src = (int*) malloc(g->capacity * sizeof(*src));
+	int *dst = (int*) malloc(g->capacity * sizeof(*dst));
+	int *w = g->weighted ? (int*) malloc(g->capacity * sizeof(*w)) : NULL;
+
+	for (i = 0; i < g->size; i++) { count[g->dst[i]+1]++; }
+	for (i = 0; i < num_ids; i++) { count[i+1] += count[i]; }
+	for (i = 0; i < g->size; i++) {
+		int e = count[g->dst[i]]++;
+		src[e] = g->src[i];
+		dst[e] = g->dst[i];
+		if (w) { w[e] = g->w[i]; }
+	}
+
+	free(count);
+	free(g->src); g->src = src;
+	free(g->dst); g->dst = dst;
+	free(g->w);   g->w   = w;
+}
+
+/* Points g straight at a binary graph file's CSR sections, which
+** GraphFile_Open has found well-formed (so targets are below the offset
+** count). Returns 0 if the file doesn't fit g (or has repeated edges that
+** dedup would drop). */
+int CSR_FromFile(CSR *g, GraphFile *gf, int dedup)
+{
+	size_t nr_offsets, nr_targets;
+	int32_t *offset = GraphFile_Get(gf, GF_OFFSETS, &nr_offsets);
+	int32_t *target = GraphFile_Get(gf, GF_TARGETS, &nr_targets);
+	int32_t *weight = GraphFile_Get(gf, GF_WEIGHTS, NULL);
+
+	if (offset == NULL || target == NULL || (g->weighted && weight == NULL)
+	|| nr_offsets != (size_t) g->nr_vertices + 2) {
+		return 0;
+	}
+
+	if (dedup) {
+		int *seen = (int*) malloc((g->nr_vertices+1) * sizeof(*seen));
+		int u, adj, repeated = 0;
+
+		for (u = 0; u <= g->nr_vertices; u++) { seen[u] = -1; }
+		for (u = 0; u <= g->nr_vertices && !repeated; u++) {
+			for (adj = offset[u]; adj < offset[u+1]; adj++) {
+				if (seen[target[adj]] == u) { repeated = 1; break; }
+				seen[target[adj]] = u;
+			}
+		}
+		free(seen);
+		if (repeated) { return 0; }
+	}
+
+	g->offset = offset;
+	g->target = target;
+	g->weight = g->weighted ? weight : NULL;
+	g->nr_edges = nr_targets;
+	g->mapped = 1;
+	return 1;
+}
+
+void CSR_Destroy(CSR *g)
+{
+	if (!g->mapped) {
+		free(g->offset);
+		free(g->target);
+		free(g->weight);
+	}
+	g->offset = g->target = g->weight = NULL;
+
+	free(g->src); g->src = NULL;
+	free(g->dst); g->dst = NULL;
+	free(g->w);   g->w   = NULL;
+}
+
+#endif
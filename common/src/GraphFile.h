@@ -0,0 +1,212 @@
+#ifndef ASA_GRAPHFILE_H
+#define ASA_GRAPHFILE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "Input.h"
+
+/*
+** A versioned, little-endian binary graph format. See "How to use asa2bin.md".
+**
+** Layout (every section starts on an 8 byte boundary):
+**   GraphFile_Header               magic "ASAG", version, kind, nr_sections
+**   GraphFile_Section[nr_sections] id, width, count, offset
+**   section payloads               arrays of int32
+**
+** Edges are stored in compressed sparse row form: the edges leaving vertex u
+** are targets[offsets[u] .. offsets[u+1]-1], in the order they were given.
+*/
+#define GRAPHFILE_MAGIC   "ASAG"
+#define GRAPHFILE_VERSION 1
+
+/* Problem layouts */
+enum graphfile_kind {
+	GF_EDGE_LIST = 1,   /* V E, E x (u v)                       */
+	GF_AIRPORT_ROADS,   /* V, A x (city cost), R x (u v cost)   */
+	GF_PIXEL_GRID,      /* m n, L, C, horizontal & vertical weights */
+	GF_SUPPLY_NETWORK,  /* f e t, capacities, minimums, t x (u v cap) */
+	GF_PROCESSORS,      /* N K, N x (x y), K x (u v cost)       */
+	GF_NR_KINDS
+};
+
+/* Section identifiers */
+enum graphfile_section_id {
+	GF_COUNTS = 1,  /* The header numbers of the text format, in order */
+	GF_OFFSETS,     /* offsets[Vertex] = Edge, one past the last id  */
+	GF_TARGETS,     /* targets[Edge]   = Vertex */
+	GF_WEIGHTS,     /* weights[Edge]   = int    */
+	GF_AIRPORTS,    /* (city, cost) pairs       */
+	GF_PIXEL_L,     /* L weight of each pixel   */
+	GF_PIXEL_C,     /* C weight of each pixel   */
+	GF_PIXEL_H,     /* Horizontal neighbor weights, row by row */
+	GF_PIXEL_V,     /* Vertical neighbor weights, row by row   */
+	GF_CAPACITIES,  /* Supplier capacities      */
+	GF_MINIMUMS,    /* Station minimums         */
+	GF_COST_X,      /* Cost of each process on processor X */
+	GF_COST_Y,      /* Cost of each process on processor Y */
+	GF_NR_SECTIONS
+};
+
+typedef struct graphfile_header {
+	char magic[4];
+	uint32_t version;
+	uint32_t kind;
+	uint32_t nr_sections;
+} GraphFile_Header;
+
+typedef struct graphfile_section {
+	uint32_t id;
+	uint32_t width;   /* Bytes per element */
+	uint64_t count;   /* Number of elements */
+	uint64_t offset;  /* From the start of the file */
+} GraphFile_Section;
+
+typedef struct graphfile {
+	uint32_t kind;
+	int32_t *data[GF_NR_SECTIONS];        /* data[id] = payload, or NULL */
+	size_t count[GF_NR_SECTIONS];         /* count[id] = elements */
+	size_t cursor[GF_NR_SECTIONS];        /* cursor[id] = next element to read */
+	size_t edge_u;                        /* Source of the next edge */
+} GraphFile;
+
+int GraphFile_LittleEndian(void)
+{
+	const uint32_t one = 1;
+	return *(const unsigned char*) &one == 1;
+}
+
+/* Whether the CSR sections are well-formed: offsets from 0 up to the number of
+** targets, never decreasing, and every target a vertex id (0 to the last) */
+int GraphFile_CheckCSR(const GraphFile *gf)
+{
+	const int32_t *offset = gf->data[GF_OFFSETS], *target = gf->data[GF_TARGETS];
+	size_t nr_offsets = gf->count[GF_OFFSETS], nr_targets = gf->count[GF_TARGETS], i;
+
+	if (offset == NULL && target == NULL) { return 1; }
+	if (offset == NULL || target == NULL || nr_offsets < 2
+	|| offset[0] != 0 || (size_t) offset[nr_offsets-1] != nr_targets) {
+		return 0;
+	}
+	if (gf->data[GF_WEIGHTS] != NULL && gf->count[GF_WEIGHTS] != nr_targets) { return 0; }
+
+	for (i = 1; i < nr_offsets; i++) {
+		if (offset[i] < offset[i-1]) { return 0; }
+	}
+	for (i = 0; i < nr_targets; i++) {
+		if (target[i] < 0 || (size_t) target[i] > nr_offsets - 2) { return 0; }
+	}
+	return 1;
+}
+
+/* Points gf at the sections of a binary graph held by in. Returns 0 for text input.
+** Everything is checked here, as solvers then index the sections as they are. */
+int GraphFile_Open(GraphFile *gf, Input *in)
+{
+	const GraphFile_Header *header = (const GraphFile_Header*) in->data;
+	const GraphFile_Section *table;
+	uint32_t i;
+
+	memset(gf, 0, sizeof(*gf));
+	if (in->size < sizeof(*header) || memcmp(header->magic, GRAPHFILE_MAGIC, 4) != 0) {
+		return 0;
+	}
+
+	if (!GraphFile_LittleEndian()) {
+		fprintf(stderr, "Binary graph files need a little-endian host.\n");
+		exit(EXIT_FAILURE);
+	}
+	if (header->version != GRAPHFILE_VERSION || header->kind == 0 || header->kind >= GF_NR_KINDS
+	|| in->size < sizeof(*header) + header->nr_sections * sizeof(*table)) {
+		fprintf(stderr, "Unsupported binary graph file (version %u, kind %u).\n",
+			(unsigned) header->version, (unsigned) header->kind);
+		exit(EXIT_FAILURE);
+	}
+
+	gf->kind = header->kind;
+	table = (const GraphFile_Section*) (in->data + sizeof(*header));
+	for (i = 0; i < header->nr_sections; i++) {
+		const GraphFile_Section *s = &table[i];
+
+		if (s->id == 0 || s->id >= GF_NR_SECTIONS || s->width != sizeof(int32_t)
+		|| s->offset % 8 != 0 || s->offset > in->size
+		|| s->count > (in->size - s->offset) / s->width) {
+			fprintf(stderr, "Corrupted section %u in binary graph file.\n", (unsigned) s->id);
+			exit(EXIT_FAILURE);
+		}
+		gf->data[s->id]  = (int32_t*) (in->data + s->offset);
+		gf->count[s->id] = s->count;
+	}
+	if (!GraphFile_CheckCSR(gf)) {
+		fprintf(stderr, "Corrupted edges in binary graph file.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	return 1;
+}
+
+/* Direct access to a section's payload. NULL if the file doesn't have it. */
+int32_t *GraphFile_Get(GraphFile *gf, int id, size_t *count)
+{
+	if (count) { *count = gf->count[id]; }
+	return gf->data[id];
+}
+
+/* Sequential access to a section, mirroring the order of the text format */
+int GraphFile_Next(GraphFile *gf, int id, int *a)
+{
+	if (gf->cursor[id] >= gf->count[id]) {
+		*a = 0;
+		return 0;
+	}
+	*a = gf->data[id][gf->cursor[id]++];
+	return 1;
+}
+
+/* Walks the CSR edges, source by source. w may be NULL. */
+int GraphFile_NextEdge(GraphFile *gf, int *u, int *v, int *w)
+{
+	int32_t *offsets = gf->data[GF_OFFSETS];
+	size_t e = gf->cursor[GF_TARGETS];
+
+	if (e >= gf->count[GF_TARGETS]) {
+		*u = *v = 0;
+		if (w) { *w = 0; }
+		return 0;
+	}
+
+	while (gf->edge_u + 1 < gf->count[GF_OFFSETS] && (size_t) offsets[gf->edge_u+1] <= e) {
+		gf->edge_u++;
+	}
+	*u = (int) gf->edge_u;
+	*v = gf->data[GF_TARGETS][e];
+	if (w) { *w = gf->data[GF_WEIGHTS] ? gf->data[GF_WEIGHTS][e] : 0; }
+	gf->cursor[GF_TARGETS]++;
+	return 1;
+}
+
+/* Standard input as a binary graph file; NULL when stdin holds text */
+GraphFile GraphFile_stdin;
+int GraphFile_stdin_state = -1;
+
+GraphFile *GraphFile_Stdin(void)
+{
+	if (GraphFile_stdin_state < 0) {
+		GraphFile_stdin_state = GraphFile_Open(&GraphFile_stdin, Input_Stdin());
+	}
+	return GraphFile_stdin_state ? &GraphFile_stdin : NULL;
+}
+
+/* Reads from whichever format stdin holds */
+#define GraphFile_Read(id, a) \
+	(GraphFile_Stdin() ? GraphFile_Next(GraphFile_Stdin(), id, a) : Input_Int(Input_Stdin(), a))
+#define GraphFile_ReadEdge(a, b) \
+	(GraphFile_Stdin() ? GraphFile_NextEdge(GraphFile_Stdin(), a, b, NULL) \
+	: (Input_Int(Input_Stdin(), a), Input_Int(Input_Stdin(), b)))
+#define GraphFile_ReadWeightedEdge(a, b, w) \
+	(GraphFile_Stdin() ? GraphFile_NextEdge(GraphFile_Stdin(), a, b, w) \
+	: (Input_Int(Input_Stdin(), a), Input_Int(Input_Stdin(), b), Input_Int(Input_Stdin(), w)))
+
+#endif
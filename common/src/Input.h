@@ -0,0 +1,163 @@
+#ifndef ASA_INPUT_H
+#define ASA_INPUT_H
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/*
+** A zero-copy reader of whitespace separated integers.
+** Regular files are memory-mapped; pipes and terminals are slurped in large
+** blocks into a single buffer. Numbers are parsed in place, without scanf's
+** per-call format and locale handling.
+*/
+#define INPUT_BLOCK (1 << 20)
+
+typedef struct input {
+	char *data;       /* data[idx] = char, always followed by a '\0' */
+	const char *cur;  /* Parsing cursor */
+	const char *end;  /* data + size */
+	size_t size;
+	int mapped;
+} Input;
+
+/* Maps (or reads) the whole of fd. The cursor starts at the first byte.
+** Aborts when out of memory; returns 0 if fd couldn't be read to its end. */
+int Input_Open(Input *in, int fd)
+{
+	struct stat st;
+	long page = sysconf(_SC_PAGESIZE);
+	int ok = 1;
+
+	in->data = NULL;
+	in->size = 0;
+	in->mapped = 0;
+
+	/* mmap gives a free '\0' sentinel when the file doesn't end on a page. When
+	** it does, a zero page is mapped right after it instead (where anonymous
+	** maps are available: not in strict ANSI C builds). */
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0
+	&& lseek(fd, 0, SEEK_CUR) == 0) {
+		/* Private & writable: solvers may use mapped arrays in place */
+		void *map = MAP_FAILED;
+
+		if (st.st_size % page != 0) {
+			map = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		}
+		#ifdef MAP_ANONYMOUS
+		else {
+			map = mmap(NULL, st.st_size + page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (map != MAP_FAILED
+			&& mmap(map, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+				munmap(map, st.st_size + page);
+				map = MAP_FAILED;
+			}
+		}
+		#endif
+		if (map != MAP_FAILED) {
+			in->data = (char*) map;
+			in->size = st.st_size;
+			in->mapped = 1;
+			#ifdef MADV_SEQUENTIAL
+			madvise(map, in->size, MADV_SEQUENTIAL);
+			#endif
+		}
+	}
+
+	/* Pipes, terminals & odd files: read everything in big blocks */
+	if (in->data == NULL) {
+		size_t cap = INPUT_BLOCK;
+		ssize_t got;
+
+		/* Out of memory, a truncated input would just give a wrong answer */
+		in->data = (char*) malloc(cap + 1);
+		if (in->data == NULL) { abort(); }
+		while ((got = read(fd, in->data + in->size, cap - in->size)) > 0) {
+			in->size += got;
+			if (in->size == cap) {
+				char *grown = (char*) realloc(in->data, 2*cap + 1);
+				if (grown == NULL) { abort(); }
+				in->data = grown;
+				cap *= 2;
+			}
+		}
+		in->data[in->size] = '\0';
+		ok = got == 0;
+	}
+
+	in->cur = in->data;
+	in->end = in->data + in->size;
+	return ok;
+}
+
+void Input_Close(Input *in)
+{
+	if (in->data == NULL) { return; }
+	if (in->mapped) {
+		munmap(in->data, in->size + 1);  /* With the zero page, if there's one */
+	} else {
+		free(in->data);
+	}
+	in->data = NULL;
+	in->cur = in->end = NULL;
+	in->size = 0;
+}
+
+/* Parses the next integer. Returns 0 (and reads 0) once the input is exhausted. */
+int Input_Long(Input *in, long *a)
+{
+	const char *p = in->cur;
+	unsigned long val = 0;
+	int neg = 0;
+
+	while (p < in->end && (unsigned)(*p - '0') > 9 && *p != '-') { p++; }
+	if (p == in->end) {
+		in->cur = p;
+		*a = 0;
+		return 0;
+	}
+
+	if (*p == '-') { neg = 1; p++; }
+	/* The trailing '\0' stops this loop; no bounds check needed */
+	while ((unsigned)(*p - '0') <= 9) { val = val*10 + (*p++ - '0'); }
+
+	in->cur = p;
+	*a = neg ? -(long) val : (long) val;
+	return 1;
+}
+
+int Input_Int(Input *in, int *a)
+{
+	long val;
+	int ok = Input_Long(in, &val);
+	*a = (int) val;
+	return ok;
+}
+
+int Input_Size(Input *in, size_t *a)
+{
+	long val;
+	int ok = Input_Long(in, &val);
+	*a = (size_t) val;
+	return ok;
+}
+
+/* Standard input, opened on first use and released at exit */
+Input Input_stdin;
+int Input_stdin_open = 0;
+
+void Input_StdinClose(void) { Input_Close(&Input_stdin); }
+
+Input *Input_Stdin(void)
+{
+	if (!Input_stdin_open) {
+		Input_stdin_open = 1;
+		if (!Input_Open(&Input_stdin, STDIN_FILENO)) { abort(); }
+		atexit(Input_StdinClose);
+	}
+	return &Input_stdin;
+}
+
+#endif
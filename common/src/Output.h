@@ -0,0 +1,125 @@
+#ifndef ASA_OUTPUT_H
+#define ASA_OUTPUT_H
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+** A buffered writer for result printers.
+** Everything is appended to a single growing buffer and written out in one go
+** when the writer is closed (at exit, for standard output). Integers are
+** converted by hand, without printf's format parsing or iostream's flushes.
+*/
+#define OUTPUT_BLOCK (1 << 20)
+
+typedef struct output {
+	char *data;       /* data[idx] = char */
+	size_t size;
+	size_t capacity;
+	int fd;
+} Output;
+
+void Output_Open(Output *out, int fd)
+{
+	out->data = NULL;
+	out->size = out->capacity = 0;
+	out->fd = fd;
+}
+
+/* Makes room for count more chars */
+void Output_Reserve(Output *out, size_t count)
+{
+	if (out->size + count > out->capacity) {
+		size_t cap = out->capacity ? out->capacity : OUTPUT_BLOCK;
+		char *grown;
+
+		while (out->size + count > cap) { cap *= 2; }
+		grown = (char*) realloc(out->data, cap);
+		if (grown == NULL) { abort(); }
+		out->data = grown;
+		out->capacity = cap;
+	}
+}
+
+void Output_Char(Output *out, char c)
+{
+	Output_Reserve(out, 1);
+	out->data[out->size++] = c;
+}
+
+void Output_String(Output *out, const char *s)
+{
+	size_t len = strlen(s);
+	Output_Reserve(out, len);
+	memcpy(out->data + out->size, s, len);
+	out->size += len;
+}
+
+void Output_Long(Output *out, long a)
+{
+	char digits[24];
+	int len = 0;
+	unsigned long val = a < 0 ? -(unsigned long) a : (unsigned long) a;
+
+	/* Digits come out backwards */
+	do {
+		digits[len++] = '0' + val % 10;
+		val /= 10;
+	} while (val > 0);
+
+	Output_Reserve(out, len + 1);
+	if (a < 0) { out->data[out->size++] = '-'; }
+	while (len > 0) { out->data[out->size++] = digits[--len]; }
+}
+
+void Output_Int(Output *out, int a) { Output_Long(out, a); }
+
+/*
+** Writes everything buffered so far, again after a signal interrupts it.
+** Output that can't be written is an error, not a shorter answer: this may
+** run from atexit, so the process ends with _exit.
+*/
+void Output_Flush(Output *out)
+{
+	size_t done = 0;
+	while (done < out->size) {
+		ssize_t got = write(out->fd, out->data + done, out->size - done);
+		if (got < 0 && errno == EINTR) { continue; }
+		if (got <= 0) {
+			fprintf(stderr, "Could not write the output: %s.\n",
+				got < 0 ? strerror(errno) : "nothing written");
+			_exit(EXIT_FAILURE);
+		}
+		done += got;
+	}
+	out->size = 0;
+}
+
+void Output_Close(Output *out)
+{
+	Output_Flush(out);
+	free(out->data);
+	out->data = NULL;
+	out->capacity = 0;
+}
+
+/* Standard output, opened on first use and written at exit */
+Output Output_stdout;
+int Output_stdout_open = 0;
+
+void Output_StdoutClose(void) { Output_Close(&Output_stdout); }
+
+Output *Output_Stdout(void)
+{
+	if (!Output_stdout_open) {
+		Output_stdout_open = 1;
+		Output_Open(&Output_stdout, STDOUT_FILENO);
+		atexit(Output_StdoutClose);
+	}
+	return &Output_stdout;
+}
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef ASA_PARALLELINPUT_H
+#define ASA_PARALLELINPUT_H
+
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "CSR.h"
+#include "Threads.h"
+
+/*
+** A multi-threaded loader for "u v" edge lists (C++ only).
+** The unread part of the input is split into newline-aligned chunks, one per
+** thread. Each thread parses its chunk into a thread-local buffer, then all
+** buffers are copied (in parallel, at their prefix-sum offsets) into the
+** CSR builder. Edges keep their input order, so CSR_Build gives the same
+** graph as adding them one by one.
+**
+** The number of threads is Threads_Count()'s. Chunks are never smaller than INPUT_PARALLEL_MIN
+** bytes, so small inputs are parsed on the calling thread alone.
+*/
+#define INPUT_PARALLEL_MIN (1 << 20)
+
+unsigned Input_Threads(size_t bytes)
+{
+	unsigned threads = Threads_Count();
+	size_t most = bytes / INPUT_PARALLEL_MIN + 1;
+
+	return threads < most ? threads : (unsigned) most;
+}
+
+/* Parses every "u v" pair between begin & end (end sits on a line start or the '\0') */
+void Input_ChunkEdges(const char *begin, const char *end, std::vector<int> *edges)
+{
+	Input chunk;
+	int u, v;
+
+	chunk.data = NULL;
+	chunk.cur = begin;
+	chunk.end = end;
+	chunk.size = end - begin;
+	chunk.mapped = 0;
+
+	edges->reserve(chunk.size / 4);
+	while (Input_Int(&chunk, &u) && Input_Int(&chunk, &v)) {
+		edges->push_back(u);
+		edges->push_back(v);
+	}
+}
+
+/* Reads num_e edges from the rest of in into g's (unweighted) builder. Adds
+** v -> u right after each u -> v when both_ways. Consumes the whole input. */
+void Input_ParallelEdges(Input *in, size_t num_e, CSR *g, bool both_ways = false)
+{
+	const char *begin = in->cur, *end = in->end;
+	unsigned t, threads = Input_Threads(end - begin);
+	std::vector<const char*> bound(threads + 1);
+	std::vector< std::vector<int> > edges(threads);
+	std::vector<size_t> first(threads + 1);
+	std::vector<std::thread> pool;
+	size_t copies = both_ways ? 2 : 1;
+
+	/* Newline-aligned chunk boundaries */
+	bound[0] = begin;
+	bound[threads] = end;
+	for (t = 1; t < threads; t++) {
+		const char *p = begin + (end - begin) / threads * t;
+		if (p < bound[t-1]) { p = bound[t-1]; }
+		while (p < end && *p != '\n') { p++; }
+		bound[t] = p < end ? p + 1 : end;
+	}
+
+	/* Parsing */
+	for (t = 1; t < threads; t++) {
+		pool.push_back(std::thread(Input_ChunkEdges, bound[t], bound[t+1], &edges[t]));
+	}
+	Input_ChunkEdges(bound[0], bound[1], &edges[0]);
+	for (t = 0; t < pool.size(); t++) { pool[t].join(); }
+	pool.clear();
+
+	/* Where each chunk's edges go; anything past num_e is dropped */
+	first[0] = g->size;
+	for (t = 0; t < threads; t++) {
+		size_t count = edges[t].size() / 2;
+		size_t left = num_e - (first[t] - g->size) / copies;
+		first[t+1] = first[t] + copies * (count < left ? count : left);
+	}
+	CSR_Reserve(g, first[threads]);
+
+	/* Merging into the builder */
+	auto merge = [&](unsigned c) {
+		size_t i, e = first[c];
+		for (i = 0; e < first[c+1]; i += 2) {
+			int u = edges[c][i], v = edges[c][i+1];
+			g->src[e] = u; g->dst[e] = v; e++;
+			if (both_ways) { g->src[e] = v; g->dst[e] = u; e++; }
+		}
+	};
+	for (t = 1; t < threads; t++) { pool.push_back(std::thread(merge, t)); }
+	merge(0);
+	for (t = 0; t < pool.size(); t++) { pool[t].join(); }
+
+	g->size = first[threads];
+	in->cur = in->end;
+}
+
+#endif
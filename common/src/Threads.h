@@ -0,0 +1,28 @@
+#ifndef ASA_THREADS_H
+#define ASA_THREADS_H
+
+#include <cstdlib>
+#include <thread>
+
+/*
+** How many threads a parallel pass runs on (C++ only): every core, or
+** ASA_THREADS when it holds a whole number, clamped to 1 .. the number of
+** cores. Anything else in it (empty, junk) is ignored.
+*/
+unsigned Threads_Count(void)
+{
+	const char *env = std::getenv("ASA_THREADS");
+	unsigned cores = std::thread::hardware_concurrency();
+	char *end;
+	long val;
+
+	if (cores == 0) { cores = 1; }
+	if (env == NULL) { return cores; }
+
+	val = std::strtol(env, &end, 10);
+	if (end == env || *end != '\0') { return cores; }
+	if (val < 1) { return 1; }
+	return (unsigned long) val < cores ? (unsigned) val : cores;
+}
+
+#endif
@@ -0,0 +1,239 @@
+/*
+** asa2bin - converts a project's text input into a binary graph file.
+** Usage: asa2bin <kind> [input [output]]
+** See "How to use asa2bin.md" for the kinds and the file layout.
+*/
+
+/* C Libraries. Only the bare minimum, no need for clutter */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+
+/* Shared libraries */
+#include "GraphFile.h"
+
+/*************************** Auxiliary functions ******************************/
+#define get_number(a) Input_Int(&input, a)
+
+Input input;
+
+void die(const char *msg)
+{
+	fprintf(stderr, "asa2bin: %s\n", msg);
+	exit(EXIT_FAILURE);
+}
+
+int32_t *alloc_ints(size_t count)
+{
+	int32_t *data = malloc((count+1) * sizeof(*data));
+	if (data == NULL) { die("out of memory"); }
+	return data;
+}
+
+/* Reads count plain numbers */
+int32_t *read_ints(size_t count)
+{
+	int32_t *data = alloc_ints(count);
+	size_t i;
+	for (i = 0; i < count; i++) {
+		int num;
+		if (!get_number(&num)) { die("input ended early"); }
+		data[i] = num;
+	}
+	return data;
+}
+
+/****************************** Output sections *******************************/
+typedef struct {
+	GraphFile_Header header;
+	GraphFile_Section sections[GF_NR_SECTIONS];
+	const int32_t *data[GF_NR_SECTIONS];
+} Output;
+
+void output_add(Output *out, int id, const int32_t *data, size_t count)
+{
+	GraphFile_Section *s = &out->sections[out->header.nr_sections];
+	s->id = id;
+	s->width = sizeof(int32_t);
+	s->count = count;
+	out->data[out->header.nr_sections++] = data;
+}
+
+void output_write(Output *out, FILE *fp)
+{
+	static const char zeros[8] = { 0 };
+	uint64_t pos = sizeof(out->header) + out->header.nr_sections * sizeof(*out->sections);
+	uint32_t i;
+
+	/* Laying out the sections, each on an 8 byte boundary */
+	for (i = 0; i < out->header.nr_sections; i++) {
+		pos = (pos + 7) & ~(uint64_t) 7;
+		out->sections[i].offset = pos;
+		pos += out->sections[i].count * out->sections[i].width;
+	}
+
+	fwrite(&out->header, sizeof(out->header), 1, fp);
+	fwrite(out->sections, sizeof(*out->sections), out->header.nr_sections, fp);
+	pos = sizeof(out->header) + out->header.nr_sections * sizeof(*out->sections);
+	for (i = 0; i < out->header.nr_sections; i++) {
+		fwrite(zeros, 1, out->sections[i].offset - pos, fp);
+		fwrite(out->data[i], out->sections[i].width, out->sections[i].count, fp);
+		pos = out->sections[i].offset + out->sections[i].count * out->sections[i].width;
+	}
+	if (ferror(fp)) { die("could not write output"); }
+}
+
+/* Reads num_e edges (and weights) and adds them as a CSR over ids [0, num_ids) */
+void output_add_edges(Output *out, size_t num_ids, size_t num_e, int weighted)
+{
+	int32_t *src    = alloc_ints(num_e);
+	int32_t *dst    = alloc_ints(num_e);
+	int32_t *w      = weighted ? alloc_ints(num_e) : NULL;
+	int32_t *offset = alloc_ints(num_ids+1);
+	int32_t *target = alloc_ints(num_e);
+	int32_t *weight = weighted ? alloc_ints(num_e) : NULL;
+	size_t i;
+
+	for (i = 0; i < num_e; i++) {
+		int u, v, c = 0;
+		if (!get_number(&u) || !get_number(&v) || (weighted && !get_number(&c))) {
+			die("input ended early");
+		}
+		if (u < 0 || v < 0 || (size_t) u >= num_ids || (size_t) v >= num_ids) {
+			die("vertex out of range");
+		}
+		src[i] = u; dst[i] = v;
+		if (weighted) { w[i] = c; }
+	}
+
+	/* Counting sort by source; stable, so each adjacency keeps its input order */
+	memset(offset, 0, (num_ids+1) * sizeof(*offset));
+	for (i = 0; i < num_e; i++) { offset[src[i]+1]++; }
+	for (i = 0; i < num_ids; i++) { offset[i+1] += offset[i]; }
+	for (i = 0; i < num_e; i++) {
+		int32_t e = offset[src[i]]++;
+		target[e] = dst[i];
+		if (weighted) { weight[e] = w[i]; }
+	}
+	for (i = num_ids; i > 0; i--) { offset[i] = offset[i-1]; }
+	offset[0] = 0;
+
+	output_add(out, GF_OFFSETS, offset, num_ids+1);
+	output_add(out, GF_TARGETS, target, num_e);
+	if (weighted) { output_add(out, GF_WEIGHTS, weight, num_e); }
+
+	free(src); free(dst); free(w);
+}
+
+/******************************** Converters **********************************/
+/* V E, then E x (u v) */
+void convert_edge_list(Output *out)
+{
+	int32_t *counts = read_ints(2);
+	output_add(out, GF_COUNTS, counts, 2);
+	output_add_edges(out, counts[0]+1, counts[1], 0);
+}
+
+/* V, A, A x (city cost), R, R x (u v cost) */
+void convert_airport_roads(Output *out)
+{
+	int32_t *counts = alloc_ints(3);
+	int32_t *airports;
+
+	get_number(&counts[0]);
+	get_number(&counts[1]);
+	airports = read_ints(2 * (size_t) counts[1]);
+	get_number(&counts[2]);
+
+	output_add(out, GF_COUNTS, counts, 3);
+	output_add(out, GF_AIRPORTS, airports, 2 * (size_t) counts[1]);
+	output_add_edges(out, counts[0]+1, counts[2], 1);
+}
+
+/* m n, then L, C, horizontal and vertical weights */
+void convert_pixel_grid(Output *out)
+{
+	int32_t *counts = read_ints(2);
+	size_t m = counts[0], n = counts[1];
+
+	output_add(out, GF_COUNTS, counts, 2);
+	output_add(out, GF_PIXEL_L, read_ints(m*n), m*n);
+	output_add(out, GF_PIXEL_C, read_ints(m*n), m*n);
+	output_add(out, GF_PIXEL_H, read_ints(m*(n-1)), m*(n-1));
+	output_add(out, GF_PIXEL_V, read_ints((m-1)*n), (m-1)*n);
+}
+
+/* f e t, f capacities, e minimums, then t x (u v capacity) */
+void convert_supply_network(Output *out)
+{
+	int32_t *counts = read_ints(3);
+
+	output_add(out, GF_COUNTS, counts, 3);
+	output_add(out, GF_CAPACITIES, read_ints(counts[0]), counts[0]);
+	output_add(out, GF_MINIMUMS, read_ints(counts[1]), counts[1]);
+	/* Source, sink, suppliers & stations */
+	output_add_edges(out, counts[0]+counts[1]+2, counts[2], 1);
+}
+
+/* N K, N x (x y), then K x (u v cost) */
+void convert_processors(Output *out)
+{
+	int32_t *counts = read_ints(2);
+	int32_t *cost_x = alloc_ints(counts[0]);
+	int32_t *cost_y = alloc_ints(counts[0]);
+	int i;
+
+	for (i = 0; i < counts[0]; i++) {
+		int x, y;
+		get_number(&x); get_number(&y);
+		cost_x[i] = x; cost_y[i] = y;
+	}
+
+	output_add(out, GF_COUNTS, counts, 2);
+	output_add(out, GF_COST_X, cost_x, counts[0]);
+	output_add(out, GF_COST_Y, cost_y, counts[0]);
+	output_add_edges(out, counts[0]+1, counts[1], 1);
+}
+
+/***************************** MAIN function **********************************/
+const char *kinds[GF_NR_KINDS] = {
+	NULL, "edges", "airports", "pixels", "supply", "processors"
+};
+
+int main(int argc, char *argv[])
+{
+	Output out;
+	FILE *fp = stdout;
+	int kind, fd = STDIN_FILENO;
+
+	if (argc < 2 || argc > 4) {
+		fprintf(stderr, "Usage: asa2bin <edges|airports|pixels|supply|processors> [input [output]]\n");
+		return EXIT_FAILURE;
+	}
+	for (kind = 1; kind < GF_NR_KINDS && strcmp(argv[1], kinds[kind]) != 0; kind++);
+	if (kind == GF_NR_KINDS) { die("unknown kind"); }
+	if (!GraphFile_LittleEndian()) { die("binary graph files need a little-endian host"); }
+
+	if (argc > 2 && (fd = open(argv[2], O_RDONLY)) < 0) { die("could not open input"); }
+	if (argc > 3 && (fp = fopen(argv[3], "wb")) == NULL) { die("could not open output"); }
+	if (!Input_Open(&input, fd)) { die("could not read input"); }
+
+	memset(&out, 0, sizeof(out));
+	memcpy(out.header.magic, GRAPHFILE_MAGIC, 4);
+	out.header.version = GRAPHFILE_VERSION;
+	out.header.kind = kind;
+
+	switch (kind) {
+		case GF_EDGE_LIST:      convert_edge_list(&out);      break;
+		case GF_AIRPORT_ROADS:  convert_airport_roads(&out);  break;
+		case GF_PIXEL_GRID:     convert_pixel_grid(&out);     break;
+		case GF_SUPPLY_NETWORK: convert_supply_network(&out); break;
+		default:                convert_processors(&out);     break;
+	}
+	output_write(&out, fp);
+
+	if (fp != stdout) { fclose(fp); }
+	Input_Close(&input);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,564 @@
+/*
+** asagen - generates synthetic inputs for every project, at any scale.
+** Usage: asagen <mode> [-n size] [-d density] [-k skew] [-w max_weight] [-s seed] [-o output]
+** See "How to use asagen.md" for the modes and what each option means for them.
+*/
+
+/* C Libraries. Only the bare minimum, no need for clutter */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <stdint.h>
+
+/* Shared libraries */
+#include "Output.h"
+
+/*************************** Auxiliary functions ******************************/
+#define max(a, b) (a < b ? b : a)
+#define min(a, b) (a > b ? b : a)
+
+#define ARTIC_BLOCK   32  /* Vertices per biconnected block (2018-2019 p1) */
+#define AIRPORT_RATIO 8   /* One city in AIRPORT_RATIO has an airport (2016-2017 p2) */
+
+Output output;
+
+void die(const char *msg)
+{
+	fprintf(stderr, "asagen: %s\n", msg);
+	exit(EXIT_FAILURE);
+}
+
+/* Keeps memory bounded on huge outputs */
+void put_int(long a, char sep)
+{
+	Output_Long(&output, a);
+	Output_Char(&output, sep);
+	if (output.size >= OUTPUT_BLOCK) { Output_Flush(&output); }
+}
+
+/***************************** Random numbers *********************************/
+/* xorshift64*: small, fast and identical on every platform */
+typedef struct rng {
+	uint64_t state;
+} Rng;
+
+void rng_seed(Rng *r, uint64_t seed)
+{
+	/* splitmix64 scrambling, so that nearby seeds give unrelated streams */
+	uint64_t z = seed + 0x9E3779B97F4A7C15;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+	r->state = (z ^ (z >> 31)) | 1;
+}
+
+uint64_t rng_next(Rng *r)
+{
+	r->state ^= r->state >> 12;
+	r->state ^= r->state << 25;
+	r->state ^= r->state >> 27;
+	return r->state * 0x2545F4914F6CDD1D;
+}
+
+/* Uniform in [0, 1) */
+double rng_double(Rng *r) { return (rng_next(r) >> 11) * (1.0 / 9007199254740992.0); }
+
+/* Uniform in [0, m) */
+size_t rng_below(Rng *r, size_t m) { return (size_t) (rng_double(r) * m); }
+
+/* Uniform in [1, m] */
+int rng_weight(Rng *r, int m) { return 1 + (int) rng_below(r, m); }
+
+/* Shuffled ids 1..n, so that no input comes out conveniently ordered */
+int *rng_permutation(Rng *r, size_t n)
+{
+	int *perm = malloc((n+1) * sizeof(*perm));
+	size_t i;
+
+	if (perm == NULL) { die("out of memory"); }
+	for (i = 0; i < n; i++) { perm[i] = i + 1; }
+	for (i = n; i > 1; i--) {
+		size_t j = rng_below(r, i);
+		int t = perm[i-1]; perm[i-1] = perm[j]; perm[j] = t;
+	}
+	return perm;
+}
+
+/******************************* Parameters ***********************************/
+typedef struct params {
+	size_t size;       /* Vertices (pixels for grids) */
+	double density;    /* Mean out-degree (nonzero neighbor ratio for grids) */
+	double skew;       /* 0 = every vertex alike; higher = heavier-tailed degrees */
+	int max_weight;    /* Weights & costs are uniform in [1, max_weight] */
+	uint64_t seed;
+} Params;
+
+/*
+** Degrees follow a Pareto law of mean p->density and shape 1 + 1/skew, so
+** skew 0 gives every vertex the same degree and larger skews give fewer,
+** bigger hubs. Fractions are rounded randomly to keep the mean exact.
+*/
+size_t draw_degree(Rng *r, const Params *p, size_t limit)
+{
+	double x = p->density;
+	size_t deg;
+
+	if (p->skew > 0) {
+		double alpha = 1 + 1 / p->skew;
+		x = p->density * (alpha - 1) / alpha / pow(1 - rng_double(r), 1 / alpha);
+	}
+	if (x >= (double) limit) { return limit; }
+
+	deg = (size_t) x;
+	if (rng_double(r) < x - deg) { deg++; }
+	return min(deg, limit);
+}
+
+/*
+** Picks k distinct numbers from [0, m) into out, with Floyd's algorithm.
+** seen is a scratch hash set with room for 2*k entries.
+*/
+void sample_distinct(Rng *r, size_t m, size_t k, size_t *out, size_t *seen, size_t buckets)
+{
+	size_t i, j, found = 0;
+
+	for (i = 0; i < buckets; i++) { seen[i] = (size_t) -1; }
+	for (j = m - k; j < m; j++) {
+		size_t t = rng_below(r, j + 1);
+		size_t h = (t * 0x9E3779B97F4A7C15) & (buckets - 1);
+
+		/* t already taken: j can't be, as it's new this round */
+		while (seen[h] != (size_t) -1 && seen[h] != t) { h = (h + 1) & (buckets - 1); }
+		if (seen[h] == t) {
+			t = j;
+			h = (t * 0x9E3779B97F4A7C15) & (buckets - 1);
+			while (seen[h] != (size_t) -1) { h = (h + 1) & (buckets - 1); }
+		}
+		seen[h] = t;
+		out[found++] = t;
+	}
+}
+
+/*
+** Every graph mode draws, for each source i in 0..n-1, a degree capped at
+** limit(i) and then that many distinct candidates among limit(i). Degrees
+** come from their own stream, so they can be summed up front for the edge
+** count that the formats print before the edges.
+*/
+typedef struct sampler {
+	Rng degrees, targets;
+	size_t *picked, *seen;
+	size_t capacity;
+} Sampler;
+
+void sampler_new(Sampler *s, const Params *p)
+{
+	rng_seed(&s->degrees, p->seed);
+	rng_seed(&s->targets, p->seed ^ 0xA5A5A5A5A5A5A5A5);
+	s->picked = s->seen = NULL;
+	s->capacity = 0;
+}
+
+void sampler_destroy(Sampler *s)
+{
+	free(s->picked); s->picked = NULL;
+	free(s->seen);   s->seen   = NULL;
+}
+
+/* Picks deg candidates out of limit into s->picked */
+void sampler_pick(Sampler *s, size_t limit, size_t deg)
+{
+	size_t buckets = 1;
+
+	while (buckets < 2 * deg) { buckets <<= 1; }
+	if (buckets > s->capacity) {
+		s->capacity = buckets;
+		s->picked = realloc(s->picked, s->capacity * sizeof(*s->picked));
+		s->seen   = realloc(s->seen,   s->capacity * sizeof(*s->seen));
+		if (s->picked == NULL || s->seen == NULL) { die("out of memory"); }
+	}
+	sample_distinct(&s->targets, limit, deg, s->picked, s->seen, buckets);
+}
+
+/* Sum of the degrees that the next pass will draw */
+size_t count_edges(const Params *p, size_t n, size_t (*limit)(const Params*, size_t), size_t forced)
+{
+	Rng r;
+	size_t i, total = forced;
+
+	rng_seed(&r, p->seed);
+	for (i = 0; i < n; i++) { total += draw_degree(&r, p, limit(p, i)); }
+	return total;
+}
+
+/********************************* Modes **************************************/
+/* Candidates after rank i, out of size ranks */
+size_t limit_after(const Params *p, size_t i) { return p->size - 1 - i; }
+/* After rank i+1, which is always connected to i */
+size_t limit_after_next(const Params *p, size_t i) { return i + 2 < p->size ? p->size - 2 - i : 0; }
+/* Any other vertex */
+size_t limit_others(const Params *p, size_t i) { (void) i; return p->size - 1; }
+
+/* 2016-2017 p1 - "V E", then a DAG over a hidden order without repeated
+** edges, with a Hamiltonian path along it so that the order is the unique answer */
+void gen_topo(const Params *p)
+{
+	Rng r;
+	Sampler s;
+	int *perm;
+	size_t i, j, n = p->size;
+
+	rng_seed(&r, p->seed + 1);
+	perm = rng_permutation(&r, n);
+	sampler_new(&s, p);
+
+	put_int(n, ' ');
+	put_int(count_edges(p, n, limit_after_next, n - 1), '\n');
+	for (i = 0; i < n; i++) {
+		size_t deg = draw_degree(&s.degrees, p, limit_after_next(p, i));
+
+		if (i + 1 < n) { put_int(perm[i], ' '); put_int(perm[i+1], '\n'); }
+		sampler_pick(&s, limit_after_next(p, i), deg);
+		for (j = 0; j < deg; j++) {
+			put_int(perm[i], ' ');
+			put_int(perm[i + 2 + s.picked[j]], '\n');
+		}
+	}
+
+	sampler_destroy(&s);
+	free(perm);
+}
+
+/* 2020-2021 p1 - "V E", then a DAG over a hidden order, without repeated edges */
+void gen_dag(const Params *p)
+{
+	Rng r;
+	Sampler s;
+	int *perm;
+	size_t i, j, n = p->size;
+
+	rng_seed(&r, p->seed + 1);
+	perm = rng_permutation(&r, n);
+	sampler_new(&s, p);
+
+	put_int(n, ' ');
+	put_int(count_edges(p, n, limit_after, 0), '\n');
+	for (i = 0; i < n; i++) {
+		size_t deg = draw_degree(&s.degrees, p, limit_after(p, i));
+
+		sampler_pick(&s, limit_after(p, i), deg);
+		for (j = 0; j < deg; j++) {
+			put_int(perm[i], ' ');
+			put_int(perm[i + 1 + s.picked[j]], '\n');
+		}
+	}
+
+	sampler_destroy(&s);
+	free(perm);
+}
+
+/* 2017-2018 p1 - "V", "E", then a directed graph without loops nor repeated edges */
+void gen_scc(const Params *p)
+{
+	Rng r;
+	Sampler s;
+	int *perm;
+	size_t i, j, n = p->size;
+
+	rng_seed(&r, p->seed + 1);
+	perm = rng_permutation(&r, n);
+	sampler_new(&s, p);
+
+	put_int(n, '\n');
+	put_int(count_edges(p, n, limit_others, 0), '\n');
+	for (i = 0; i < n; i++) {
+		size_t deg = draw_degree(&s.degrees, p, limit_others(p, i));
+
+		sampler_pick(&s, limit_others(p, i), deg);
+		for (j = 0; j < deg; j++) {
+			put_int(perm[i], ' ');
+			put_int(perm[(i + 1 + s.picked[j]) % n], '\n');
+		}
+	}
+
+	sampler_destroy(&s);
+	free(perm);
+}
+
+/* Candidates after rank i within its block */
+size_t limit_block(const Params *p, size_t i)
+{
+	size_t end = min(p->size, (i / ARTIC_BLOCK + 1) * ARTIC_BLOCK);
+	return end - 1 - i;
+}
+/* Same, minus rank i+1 (the block's path) */
+size_t limit_block_next(const Params *p, size_t i) { return limit_block(p, i) > 0 ? limit_block(p, i) - 1 : 0; }
+
+/* 2018-2019 p1 - "V", "E", then an undirected graph of ARTIC_BLOCK-sized
+** blocks. Blocks hang from earlier ones by a single edge, so the vertices
+** holding them together are articulation points. */
+void gen_artic(const Params *p)
+{
+	Rng r;
+	Sampler s;
+	int *perm;
+	size_t i, j, n = p->size;
+	size_t blocks = (n + ARTIC_BLOCK - 1) / ARTIC_BLOCK;
+
+	rng_seed(&r, p->seed + 1);
+	perm = rng_permutation(&r, n);
+	sampler_new(&s, p);
+
+	/* Each block has a path through it, plus one edge up to an earlier block */
+	put_int(n, '\n');
+	put_int(count_edges(p, n, limit_block_next, (n - blocks) + (blocks - 1)), '\n');
+	for (i = 0; i < n; i++) {
+		size_t deg = draw_degree(&s.degrees, p, limit_block_next(p, i));
+
+		if (i % ARTIC_BLOCK == 0 && i > 0) {
+			size_t up = rng_below(&r, i);
+			put_int(perm[i], ' '); put_int(perm[up], '\n');
+		}
+		if (limit_block(p, i) > 0) { put_int(perm[i], ' '); put_int(perm[i+1], '\n'); }
+
+		sampler_pick(&s, limit_block_next(p, i), deg);
+		for (j = 0; j < deg; j++) {
+			put_int(perm[i], ' ');
+			put_int(perm[i + 2 + s.picked[j]], '\n');
+		}
+	}
+
+	sampler_destroy(&s);
+	free(perm);
+}
+
+/* 2016-2017 p2 - "V", airports ("A", then "city cost"), roads ("R", then
+** "city city cost"). A random spanning tree keeps the cities connected. */
+void gen_airports(const Params *p)
+{
+	Rng r, costs;
+	Sampler s;
+	int *perm;
+	size_t i, j, n = p->size, num_airports = 0;
+
+	rng_seed(&r, p->seed + 1);
+	rng_seed(&costs, p->seed + 2);
+	perm = rng_permutation(&r, n);
+	sampler_new(&s, p);
+
+	/* Airports first: one stream decides who has them, another their cost */
+	put_int(n, '\n');
+	rng_seed(&r, p->seed + 3);
+	for (i = 0; i < n; i++) { num_airports += rng_below(&r, AIRPORT_RATIO) == 0; }
+	put_int(num_airports, '\n');
+	rng_seed(&r, p->seed + 3);
+	for (i = 0; i < n; i++) {
+		if (rng_below(&r, AIRPORT_RATIO) == 0) {
+			put_int(i + 1, ' ');
+			put_int(rng_weight(&costs, p->max_weight), '\n');
+		}
+	}
+
+	put_int(count_edges(p, n, limit_after, n - 1), '\n');
+	rng_seed(&r, p->seed + 4);
+	for (i = 0; i < n; i++) {
+		size_t deg = draw_degree(&s.degrees, p, limit_after(p, i));
+
+		if (i > 0) {
+			put_int(perm[i], ' ');
+			put_int(perm[rng_below(&r, i)], ' ');
+			put_int(rng_weight(&costs, p->max_weight), '\n');
+		}
+		sampler_pick(&s, limit_after(p, i), deg);
+		for (j = 0; j < deg; j++) {
+			put_int(perm[i], ' ');
+			put_int(perm[i + 1 + s.picked[j]], ' ');
+			put_int(rng_weight(&costs, p->max_weight), '\n');
+		}
+	}
+
+	sampler_destroy(&s);
+	free(perm);
+}
+
+/* 2017-2018 p2 - "m n", then the L, C, horizontal and vertical weight matrices.
+** density is the share of neighbor weights that are not 0. */
+void gen_pixels(const Params *p)
+{
+	Rng r;
+	size_t i, j, m, n;
+
+	m = (size_t) sqrt((double) p->size);
+	m = max(m, 1);
+	n = max(p->size / m, 2);
+	rng_seed(&r, p->seed);
+
+	put_int(m, ' ');
+	put_int(n, '\n');
+	for (i = 0; i < 2 * m; i++) {
+		Output_Char(&output, '\n');
+		for (j = 0; j < n; j++) { put_int(rng_weight(&r, p->max_weight) - 1, ' '); }
+	}
+	Output_Char(&output, '\n');
+	for (i = 0; i < m + (m - 1); i++) {
+		size_t cols = i < m ? n - 1 : n;
+		Output_Char(&output, '\n');
+		for (j = 0; j < cols; j++) {
+			int w = rng_double(&r) < p->density ? rng_weight(&r, p->max_weight) : 0;
+			put_int(w, ' ');
+		}
+	}
+	Output_Char(&output, '\n');
+}
+
+/* Suppliers (first quarter) & stations (the rest) of the supply network */
+size_t supply_suppliers(const Params *p) { return max(p->size / 4, 1); }
+size_t supply_stations(const Params *p) { return max(p->size - supply_suppliers(p), 1); }
+
+/* Suppliers reach any station or the sink; stations reach later ones or the
+** sink. Edges never come in antiparallel pairs. */
+size_t limit_supply(const Params *p, size_t i)
+{
+	size_t f = supply_suppliers(p), e = supply_stations(p);
+	return i < f ? e + 1 : (f + e - 1 - i) + 1;
+}
+
+/* Candidate c (out of limit_supply(i)) of source i, as a vertex id */
+int supply_target(const Params *p, size_t i, size_t c)
+{
+	size_t f = supply_suppliers(p);
+	size_t first = i < f ? f + 2 : i + 3; /* First station reachable */
+
+	return c == 0 ? 1 : (int) (first + c - 1);
+}
+
+/* 2018-2019 p2 - "f e t", supplier capacities, station minimums, then
+** t x "origin destination capacity". Vertex 1 is the sink, suppliers are
+** 2..f+1 and stations f+2..f+e+1. */
+void gen_supply(const Params *p)
+{
+	Rng weights;
+	Sampler s;
+	size_t i, j, f = supply_suppliers(p), e = supply_stations(p);
+
+	rng_seed(&weights, p->seed + 1);
+	sampler_new(&s, p);
+
+	put_int(f, ' ');
+	put_int(e, ' ');
+	put_int(count_edges(p, f + e, limit_supply, 0), '\n');
+	for (i = 0; i < f; i++) { put_int(rng_weight(&weights, p->max_weight), ' '); }
+	Output_Char(&output, '\n');
+	for (i = 0; i < e; i++) { put_int(rng_weight(&weights, p->max_weight), ' '); }
+	Output_Char(&output, '\n');
+
+	for (i = 0; i < f + e; i++) {
+		size_t deg = draw_degree(&s.degrees, p, limit_supply(p, i));
+
+		sampler_pick(&s, limit_supply(p, i), deg);
+		for (j = 0; j < deg; j++) {
+			put_int(i + 2, ' ');
+			put_int(supply_target(p, i, s.picked[j]), ' ');
+			put_int(rng_weight(&weights, p->max_weight), '\n');
+		}
+	}
+
+	sampler_destroy(&s);
+}
+
+/* 2020-2021 p2 - "N K", N x "x y" processor costs, then K x "u v cost" with u < v */
+void gen_processors(const Params *p)
+{
+	Rng weights;
+	Sampler s;
+	size_t i, j, n = p->size;
+
+	rng_seed(&weights, p->seed + 1);
+	sampler_new(&s, p);
+
+	put_int(n, ' ');
+	put_int(count_edges(p, n, limit_after, 0), '\n');
+	for (i = 0; i < n; i++) {
+		put_int(rng_weight(&weights, p->max_weight), ' ');
+		put_int(rng_weight(&weights, p->max_weight), '\n');
+	}
+
+	for (i = 0; i < n; i++) {
+		size_t deg = draw_degree(&s.degrees, p, limit_after(p, i));
+
+		sampler_pick(&s, limit_after(p, i), deg);
+		for (j = 0; j < deg; j++) {
+			put_int(i + 1, ' ');
+			put_int(i + 2 + s.picked[j], ' ');
+			put_int(rng_weight(&weights, p->max_weight), '\n');
+		}
+	}
+
+	sampler_destroy(&s);
+}
+
+/***************************** MAIN function **********************************/
+typedef struct mode {
+	const char *name;
+	void (*generate)(const Params*);
+	double density;   /* Default */
+} Mode;
+
+const Mode modes[] = {
+	{ "topo",       gen_topo,       4   },  /* 2016-2017 p1 */
+	{ "airports",   gen_airports,   4   },  /* 2016-2017 p2 */
+	{ "scc",        gen_scc,        2   },  /* 2017-2018 p1 */
+	{ "pixels",     gen_pixels,     0.5 },  /* 2017-2018 p2 */
+	{ "artic",      gen_artic,      2   },  /* 2018-2019 p1 */
+	{ "supply",     gen_supply,     3   },  /* 2018-2019 p2 */
+	{ "dag",        gen_dag,        4   },  /* 2020-2021 p1 */
+	{ "processors", gen_processors, 2   },  /* 2020-2021 p2 */
+	{ NULL, NULL, 0 }
+};
+
+int main(int argc, char *argv[])
+{
+	const Mode *mode;
+	Params p;
+	int i, fd = STDOUT_FILENO;
+
+	if (argc < 2) {
+		fprintf(stderr, "Usage: asagen <topo|airports|scc|pixels|artic|supply|dag|processors>"
+			" [-n size] [-d density] [-k skew] [-w max_weight] [-s seed] [-o output]\n");
+		return EXIT_FAILURE;
+	}
+	for (mode = modes; mode->name != NULL && strcmp(argv[1], mode->name) != 0; mode++);
+	if (mode->name == NULL) { die("unknown mode"); }
+
+	p.size = 1000;
+	p.density = mode->density;
+	p.skew = 0;
+	p.max_weight = 100;
+	p.seed = 1;
+
+	for (i = 2; i + 1 < argc; i += 2) {
+		const char *opt = argv[i], *val = argv[i+1];
+
+		if      (strcmp(opt, "-n") == 0) { p.size = strtoul(val, NULL, 10); }
+		else if (strcmp(opt, "-d") == 0) { p.density = strtod(val, NULL); }
+		else if (strcmp(opt, "-k") == 0) { p.skew = strtod(val, NULL); }
+		else if (strcmp(opt, "-w") == 0) { p.max_weight = atoi(val); }
+		else if (strcmp(opt, "-s") == 0) { p.seed = strtoul(val, NULL, 10); }
+		else if (strcmp(opt, "-o") == 0) {
+			fd = open(val, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+			if (fd < 0) { die("could not open output"); }
+		}
+		else { die("unknown option"); }
+	}
+	if (i < argc) { die("option without a value"); }
+	if (p.size < 2 || p.size > 0x7FFFFFFF) { die("size must be between 2 and 2^31-1"); }
+	if (p.density < 0 || p.skew < 0 || p.max_weight < 1) { die("density, skew & max_weight can't be negative"); }
+
+	Output_Open(&output, fd);
+	mode->generate(&p);
+	Output_Close(&output);
+
+	if (fd != STDOUT_FILENO) { close(fd); }
+	return EXIT_SUCCESS;
+}
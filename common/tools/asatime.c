@@ -0,0 +1,63 @@
+/*
+** asatime - runs a command and records what it cost.
+** Usage: asatime report command [args...]
+** stdin & stdout go straight to the command. Once it exits, one CSV line is
+** written to report: wall seconds, user seconds, system seconds, peak RSS (KiB).
+** Exits with the command's status (128 + signal if it was killed).
+*/
+#define _DEFAULT_SOURCE /* getrusage's children & gettimeofday under -ansi */
+
+/* C Libraries. Only the bare minimum, no need for clutter */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+double seconds(struct timeval tv) { return tv.tv_sec + tv.tv_usec * 1e-6; }
+
+int main(int argc, char *argv[])
+{
+	struct timeval start, end;
+	struct rusage usage;
+	FILE *fp;
+	pid_t pid;
+	int status;
+
+	if (argc < 3) {
+		fprintf(stderr, "Usage: asatime report command [args...]\n");
+		return EXIT_FAILURE;
+	}
+
+	gettimeofday(&start, NULL);
+	pid = fork();
+	if (pid < 0) {
+		perror("asatime: fork");
+		return EXIT_FAILURE;
+	}
+	if (pid == 0) {
+		execvp(argv[2], &argv[2]);
+		perror("asatime: exec");
+		_exit(127);
+	}
+	if (waitpid(pid, &status, 0) < 0) {
+		perror("asatime: waitpid");
+		return EXIT_FAILURE;
+	}
+	gettimeofday(&end, NULL);
+
+	/* Only one child ever ran, so its usage is all of the children's */
+	getrusage(RUSAGE_CHILDREN, &usage);
+	if ((fp = fopen(argv[1], "w")) == NULL) {
+		perror("asatime: report");
+		return EXIT_FAILURE;
+	}
+	fprintf(fp, "%.6f,%.6f,%.6f,%ld\n",
+		seconds(end) - seconds(start), seconds(usage.ru_utime), seconds(usage.ru_stime),
+		usage.ru_maxrss);
+	fclose(fp);
+
+	if (WIFSIGNALED(status)) { return 128 + WTERMSIG(status); }
+	return WEXITSTATUS(status);
+}
@@ -7,8 +7,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+/* Shared libraries */
+#include "GraphFile.h"
+#include "Bench.h"
+
 /*************************** Auxiliary functions ******************************/
-#define get_numbers(a, b) scanf("%d %d", a, b)
+#define get_numbers(a, b) (GraphFile_Read(GF_COUNTS, a), GraphFile_Read(GF_COUNTS, b))
+#define get_edge(a, b)    GraphFile_ReadEdge(a, b)
 
 /*********************** Visit States & Graph Status **************************/
 enum graphStatus {
@@ -28,6 +33,7 @@ struct queue {
 #define enqueue(a)      Queue.data[Queue.rear++] = a
 #define dequeue()       Queue.data[Queue.front++]
 #define is_empty()     (Queue.front == Queue.rear)
+#define queue_size()   (Queue.rear - Queue.front)
 #define destroy_queue() free(Queue.data); Queue.data = NULL
 
 /* Vertex Structure */
@@ -47,6 +53,7 @@ typedef struct graph {
 	unsigned char status;
 
 	Edge *first;    /* first[Vertex] = Edge   */
+	Edge *last;     /* last[Vertex]  = Edge   */
 	Vertex *vertex; /* vertex[Edge]  = Vertex */
 	Edge *next;     /* next[Edge]    = Edge   */
 
@@ -61,17 +68,16 @@ void connect_graph(Graph *g, Vertex a, Vertex b) {
 	g->vertex[g->nr_edges] = new_edge(b);
 	g->indegree[b]++;
 
+	/* Appending after a's last edge keeps the input order */
 	if ( g->first[a] == 0 ) {
 		g->first[a] = g->nr_edges;
 
 	} else {
 
-		Edge find_edge = find_edge = g->first[a];
-
-		for ( ; g->next[find_edge] != 0; find_edge = g->next[find_edge] );
-		g->next[find_edge] = g->nr_edges;
+		g->next[g->last[a]] = g->nr_edges;
 
 	}
+	g->last[a] = g->nr_edges;
 
 }
 
@@ -83,6 +89,7 @@ void init_graph(Graph *g, int num_v, int num_e) {
 	g->status      = INCOHERENT;
 
 	g->first    = calloc((num_v+1), sizeof(g->first));
+	g->last     = calloc((num_v+1), sizeof(g->last));
 	g->vertex   = calloc((num_e+1), sizeof(g->vertex));
 	g->next     = calloc((num_e+1), sizeof(g->next));
 
@@ -93,7 +100,7 @@ void init_graph(Graph *g, int num_v, int num_e) {
 		int num1, num2;
 		Vertex v;
 
-		get_numbers(&num1, &num2);
+		get_edge(&num1, &num2);
 		u = new_vertex(num1);
 		v = new_vertex(num2);
 
@@ -111,6 +118,7 @@ void init_graph(Graph *g, int num_v, int num_e) {
 
 void destroy_graph(Graph *g) {
 	free(g->first);    g->first    = NULL;
+	free(g->last);     g->last     = NULL;
 	free(g->vertex);   g->vertex   = NULL;
 	free(g->next);     g->next     = NULL;
 	free(g->indegree); g->indegree = NULL;
@@ -140,36 +148,31 @@ const char *examine_graph(Graph *g) {
 }
 
 /************************* Vertex "Deletion" Algorithm ***************************/
+/* The order is unique only if there's never more than 1 vertex that could go
+** next. The queue is still drained when it isn't: Incoerente wins. */
 void graph_sort(Graph *g) {
-	int count = 0;
+	int count = 0, unique = 1;
 
 	while ( !is_empty() ) {
-		Vertex u = dequeue();
-		g->result[count++] = u;
+		Vertex u;
+		Edge find_son;
 
-		if ( g->indegree[u] == 0 ) {
-			Edge find_son;
-			int max_solutions = 0;
+		if (queue_size() > 1) { unique = 0; }
 
-			for ( find_son = g->first[u]; find_son != 0; find_son = g->next[find_son] ) {
-				Vertex v = g->vertex[find_son];
+		u = dequeue();
+		g->result[count++] = u;
 
-				if ( --g->indegree[v] == 0 ) {
-					enqueue(v);
-					max_solutions++;
-				}
+		for ( find_son = g->first[u]; find_son != 0; find_son = g->next[find_son] ) {
+			Vertex v = g->vertex[find_son];
 
-				/* If suddenly u has more than 1 adjacent whose indegree == 0 */
-				if (max_solutions > 1) {
-					g->status = INSUFFICIENT;
-					return;
-				}
+			if ( --g->indegree[v] == 0 ) {
+				enqueue(v);
 			}
 		}
 	}
 
 	if ( count == g->nr_vertices ) {
- 		g->status = CORRECT;
+ 		g->status = unique ? CORRECT : INSUFFICIENT;
  	}
 }
 
@@ -178,12 +181,15 @@ int main(void) {
 	int num_v, num_e;
 	Graph g;
 
+	Bench_Phase(BENCH_PARSE);
 	get_numbers(&num_v, &num_e);
 	new_queue(num_v);
 	init_graph(&g, num_v, num_e);
 
+	Bench_Phase(BENCH_SOLVE);
 	graph_sort(&g);
 
+	Bench_Phase(BENCH_OUTPUT);
 	printf("%s\n", examine_graph(&g));
 
 	destroy_graph(&g);
@@ -5,11 +5,23 @@
 
 /* Libraries. Only the bare minimum, no need for clutter */
 #include <stdio.h>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <thread>
+#include <unordered_set>
 #include <vector>
 
+/* Shared libraries */
+#include "GraphFile.h"
+#include "Bench.h"
+#include "Threads.h"
+
 /*************************** Auxiliary functions ******************************/
-#define get_numbers(a, b) scanf("%d %d", a, b)
+#define get_numbers(a, b) (GraphFile_Read(GF_COUNTS, a), GraphFile_Read(GF_COUNTS, b))
+#define get_edge(a, b)    GraphFile_ReadEdge(a, b)
 
 /*********************** Visit States & Graph Status **************************/
 enum graphStatus {
@@ -18,10 +30,18 @@ enum graphStatus {
 	INSUFFICIENT
 };
 
+/* Both the sorts & the online order answer by this rule: a cycle leaves no
+** order at all, so Incoerente wins over an order that isn't unique */
+graphStatus order_status(bool cyclic, bool unique) {
+	if (cyclic) { return INCOHERENT; }
+	return unique ? CORRECT : INSUFFICIENT;
+}
+
 /******************** Data structures and their "methods" *********************/
 
 /* Vertex Structure */
 typedef int Vertex;
+#define NIL_VERTEX 0
 #define new_vertex(a) a
 #define next_vertex(a) a + 1
 
@@ -29,6 +49,24 @@ typedef int Vertex;
 typedef int Edge;
 #define new_edge(a) a
 
+/* Graphs with at least this many vertices are sorted level by level (see
+** Graph::sort_levels), on Threads_Count() threads. A level's edges are split
+** across threads only once there are SORT_PARALLEL_MIN of them.
+** ASA_SORT=queue or ASA_SORT=levels picks either sort whatever the size, and
+** ASA_SORT=online answers with the online order (as --online does). */
+#define SORT_LEVELS_MIN   (1 << 16)
+#define SORT_PARALLEL_MIN (1 << 12)
+
+/* Level-synchronous sort state, with the edges laid out by source vertex */
+struct Level {
+	std::vector<Edge> first;                    /* Vertex's edges: first[Vertex] to first[Vertex+1] */
+	std::vector<Vertex> target;                 /* target[Edge] = Vertex */
+	std::vector<std::atomic<int> > indegree;
+	std::vector< std::vector<Vertex> > released; /* released[part] = Vertices it released */
+
+	Level(size_t size, unsigned parts) : first(size + 1), indegree(size), released(parts) {}
+};
+
 /* Global queue */
 std::vector<Vertex> queue;
 #define enqueue(a) queue.push_back(a)
@@ -42,12 +80,18 @@ class Graph {
 		unsigned char _status;
 
 		std::vector<Edge> _first;    /* _first[Vertex] = Edge   */
+		std::vector<Edge> _last;     /* _last[Vertex]  = Edge   */
 		std::vector<Vertex> _vertex; /* _vertex[Edge]  = Vertex */
 		std::vector<Edge> _next;     /* _next[Edge]    = Edge   */
 
 		std::vector<int> _indegree;
 		std::vector<Vertex> _result;
 
+		void sort_queue();
+		void sort_levels(unsigned threads);
+		void level_release(Level *lv, unsigned part, Edge begin, Edge end);
+		void level_run(Level *lv, Vertex u, unsigned threads);
+
 	public:
 		Graph(int num_v, int num_e);
 		~Graph();
@@ -61,6 +105,7 @@ Graph::Graph(int num_v, int num_e) {
 
 	_status   = INCOHERENT;
 	_first    = std::vector<Edge>(num_v+1);
+	_last     = std::vector<Edge>(num_v+1);
 	_vertex   = std::vector<Vertex>(num_e+1);
 	_next     = std::vector<Edge>(num_e+1);
 
@@ -70,7 +115,7 @@ Graph::Graph(int num_v, int num_e) {
 		int num1, num2;
 		Vertex v;
 
-		get_numbers(&num1, &num2);
+		get_edge(&num1, &num2);
 		u = new_vertex(num1);
 		v = new_vertex(num2);
 
@@ -91,14 +136,13 @@ void Graph::connect(Vertex a, Vertex b) {
 	_vertex[_nr_edges] = new_edge(b);
 	_indegree[b]++;
 
+	/* Appending after a's last edge keeps the input order */
 	if ( _first[a] == 0 ) {
 		_first[a] = _nr_edges;
 	} else {
-		Edge find_edge = _first[a];
-
-		for ( ; _next[find_edge] != 0; find_edge = _next[find_edge] );
-		_next[find_edge] = _nr_edges;
+		_next[_last[a]] = _nr_edges;
 	}
+	_last[a] = _nr_edges;
 }
 
 /* Examines Graph */
@@ -121,43 +165,323 @@ std::ostream& operator<<(std::ostream& os, const Graph &graph) {
 }
 
 /************************* Vertex "Deletion" Algorithm ***************************/
-void Graph::sort() {
+/*
+** The order is unique only if there's never more than 1 vertex that could go
+** next. Kahn's queue is still drained when it isn't: a cycle leaves vertices
+** out, and Incoerente wins over Insuficiente. Both sorts give the same answers.
+*/
+void Graph::sort_queue() {
+	bool unique = true;
+
+	while ( !is_empty() ) {
+		if (queue.size() > 1) { unique = false; }
+
+		Vertex u = dequeue();
+		_result.push_back(u);
+
+		for ( Edge find_son = _first[u]; find_son != 0; find_son = _next[find_son] ) {
+			Vertex v = _vertex[find_son];
+
+			if ( --_indegree[v] == 0 ) {
+				enqueue(v);
+			}
+		}
+	}
+
+	_status = order_status(_result.size() < _first.size() - 1, unique);
+}
+
+/*
+** Level-synchronous Kahn: a level is the vertex that goes next, and all of its
+** edges are handled at once, split across threads. Each thread keeps the
+** vertices it released, and they're queued in the order of the edges.
+*/
+void Graph::level_release(Level *lv, unsigned part, Edge begin, Edge end) {
+	lv->released[part].clear();
+
+	for (Edge e = begin; e < end; e++) {
+		Vertex v = lv->target[e];
+
+		/* Only the thread that took v's indegree to 0 sees it at 1 */
+		if (lv->indegree[v].fetch_sub(1, std::memory_order_relaxed) == 1) {
+			lv->released[part].push_back(v);
+		}
+	}
+}
+
+/* Runs through u's edges, split across threads if there are enough of them,
+** and queues the vertices u released */
+void Graph::level_run(Level *lv, Vertex u, unsigned threads) {
+	Edge begin = lv->first[u], size = lv->first[u+1] - begin;
+	std::vector<std::thread> pool;
+
+	if (size < SORT_PARALLEL_MIN) { threads = 1; }
+	for (unsigned t = 1; t < threads; t++) {
+		pool.push_back(std::thread(&Graph::level_release, this, lv, t,
+			begin + (Edge) ((long long) size * t / threads), begin + (Edge) ((long long) size * (t+1) / threads)));
+	}
+	level_release(lv, 0, begin, begin + (Edge) ((long long) size / threads));
+	for (size_t t = 0; t < pool.size(); t++) { pool[t].join(); }
+
+	for (unsigned t = 0; t < threads; t++) {
+		queue.insert(queue.end(), lv->released[t].begin(), lv->released[t].end());
+	}
+}
+
+void Graph::sort_levels(unsigned threads) {
+	Level lv(_indegree.size(), threads);
+	bool unique = true;
+
+	/* Lays the edges out by source, in each list's order */
+	for (size_t u = 1; u < _first.size(); u++) {
+		lv.first[u] = lv.target.size();
+		for ( Edge find_son = _first[u]; find_son != 0; find_son = _next[find_son] ) {
+			lv.target.push_back(_vertex[find_son]);
+		}
+	}
+	lv.first[_first.size()] = lv.target.size();
+	for (size_t u = 0; u < _indegree.size(); u++) {
+		lv.indegree[u].store(_indegree[u], std::memory_order_relaxed);
+	}
+
 	while ( !is_empty() ) {
+		if (queue.size() > 1) { unique = false; }
+
 		Vertex u = dequeue();
 		_result.push_back(u);
+		level_run(&lv, u, threads);
+	}
+
+	_status = order_status(_result.size() < _first.size() - 1, unique);
+}
 
-		if ( _indegree[u] == 0 ) {
-			int max_solutions = 0;
+void Graph::sort() {
+	const char *mode = std::getenv("ASA_SORT");
+	bool levels = _first.size() - 1 >= SORT_LEVELS_MIN;
 
-			for ( Edge find_son = _first[u]; find_son != 0; find_son = _next[find_son] ) {
-				Vertex v = _vertex[find_son];
+	if (mode != NULL) { levels = std::strcmp(mode, "levels") == 0; }
+	if (!levels) {
+		sort_queue();
+	} else {
+		sort_levels(Threads_Count());
+	}
+}
+
+/************************* Online Order (Pearce-Kelly) *************************/
+/*
+** Keeps a topological order while edges arrive one at a time, so the answer is
+** always at hand instead of being sorted again from scratch.
+** An edge a -> b that already agrees with the order costs O(1). Otherwise only
+** the vertices between b and a in the order are searched (forwards from b,
+** backwards from a) and shuffled, reusing their own positions (Pearce & Kelly,
+** "A dynamic topological sort algorithm for directed acyclic graphs", 2006).
+** Reaching a from b means a cycle, which no later edge can undo.
+** The order is unique exactly when every 2 consecutive vertices are connected,
+** so the number of such pairs is kept up to date with each shuffle.
+*/
+class OnlineGraph {
+	private:
+		bool _cyclic;
+		int _linked;                       /* Consecutive pairs with an edge */
+		int _mark;                         /* Current search's visit mark    */
+
+		std::vector<int> _ord;             /* _ord[Vertex] = position */
+		std::vector<Vertex> _pos;          /* _pos[position] = Vertex */
+		std::vector< std::vector<Vertex> > _out, _in;
+		std::vector<int> _visited;         /* _visited[Vertex] = mark */
+		std::unordered_set<unsigned long long> _edges;
+		std::vector<Vertex> _forward, _backward;  /* Scratch space for connect */
+		std::vector<int> _slots, _pairs;
+
+		bool has_edge(Vertex a, Vertex b) const;
+		bool linked(int i) const;
+		bool search(Vertex from, int bound, bool forward, Vertex stop, std::vector<Vertex> *found);
+
+	public:
+		OnlineGraph(int num_v);
+		~OnlineGraph();
+		void connect(Vertex a, Vertex b);
+		graphStatus status() const;
+		friend std::ostream& operator<<(std::ostream& os, const OnlineGraph &graph);
+};
 
-				if ( --_indegree[v] == 0 ) {
-					enqueue(v);
-					max_solutions++;
-				}
+#define edge_key(a, b) ((unsigned long long) (unsigned) (a) << 32 | (unsigned) (b))
 
-				/* If suddenly u has more than 1 adjacent whose _indegree == 0 */
-				if (max_solutions > 1) {
-					_status = INSUFFICIENT;
-					return;
-				}
+OnlineGraph::OnlineGraph(int num_v) {
+	_cyclic = false;
+	_linked = 0;
+	_mark   = 0;
+
+	_ord     = std::vector<int>(num_v+1);
+	_pos     = std::vector<Vertex>(num_v);
+	_out     = std::vector< std::vector<Vertex> >(num_v+1);
+	_in      = std::vector< std::vector<Vertex> >(num_v+1);
+	_visited = std::vector<int>(num_v+1);
+
+	/* Without edges, any order will do */
+	for (Vertex u = 1; u <= num_v; u = next_vertex(u)) {
+		_ord[u] = u - 1;
+		_pos[u - 1] = u;
+	}
+}
+
+OnlineGraph::~OnlineGraph() { /* Nothing here */ }
+
+bool OnlineGraph::has_edge(Vertex a, Vertex b) const {
+	return _edges.count(edge_key(a, b)) > 0;
+}
+
+/* Whether positions i & i+1 hold connected vertices. Scanning the shorter
+** adjacency list beats hashing, as most vertices only have a few edges */
+bool OnlineGraph::linked(int i) const {
+	if (i < 0 || i + 1 >= (int) _pos.size()) { return false; }
+
+	Vertex u = _pos[i], v = _pos[i+1];
+	if (_out[u].size() <= _in[v].size()) {
+		return std::find(_out[u].begin(), _out[u].end(), v) != _out[u].end();
+	}
+	return std::find(_in[v].begin(), _in[v].end(), u) != _in[v].end();
+}
+
+/* Collects what's reachable from "from" (along _out if forward, _in otherwise)
+** without crossing bound. Returns false as soon as stop is reached. */
+bool OnlineGraph::search(Vertex from, int bound, bool forward, Vertex stop, std::vector<Vertex> *found) {
+	std::vector<Vertex> st(1, from);
+
+	_visited[from] = _mark;
+	while (!st.empty()) {
+		Vertex u = st.back(); st.pop_back();
+		const std::vector<Vertex> &adj = forward ? _out[u] : _in[u];
+
+		found->push_back(u);
+		for (size_t i = 0; i < adj.size(); i++) {
+			Vertex v = adj[i];
+
+			if (v == stop) { return false; }
+			if (_visited[v] != _mark && (forward ? _ord[v] < bound : _ord[v] > bound)) {
+				_visited[v] = _mark;
+				st.push_back(v);
 			}
 		}
 	}
+	return true;
+}
 
-	if ( _result.size() == _first.size() - 1 ) {
- 		_status = CORRECT;
- 	}
+/* Connects two Vertices */
+void OnlineGraph::connect(Vertex a, Vertex b) {
+	std::vector<Vertex> &forward = _forward, &backward = _backward;
+	std::vector<int> &slots = _slots, &pairs = _pairs;
+	int lower = _ord[b], upper = _ord[a];
+
+	if (_cyclic || has_edge(a, b)) { return; }
+	if (a == b) { _cyclic = true; return; }
+
+	_edges.insert(edge_key(a, b));
+	_out[a].push_back(b);
+	_in[b].push_back(a);
+
+	/* Already in order */
+	if (lower > upper) {
+		if (lower == upper + 1) { _linked++; }
+		return;
+	}
+
+	/* Whatever b reaches must now come after whatever reaches a */
+	forward.clear(); backward.clear(); slots.clear(); pairs.clear();
+	_mark++;
+	if (!search(b, upper, true, a, &forward)) {
+		_cyclic = true;
+		return;
+	}
+	search(a, lower, false, NIL_VERTEX, &backward);
+
+	/* Both sets keep their inner order; backward takes the first slots */
+	for (size_t i = 0; i < forward.size(); i++) { slots.push_back(_ord[forward[i]]); }
+	for (size_t i = 0; i < backward.size(); i++) { slots.push_back(_ord[backward[i]]); }
+	std::sort(slots.begin(), slots.end());
+	std::sort(forward.begin(), forward.end(), [this](Vertex u, Vertex v) { return _ord[u] < _ord[v]; });
+	std::sort(backward.begin(), backward.end(), [this](Vertex u, Vertex v) { return _ord[u] < _ord[v]; });
+	backward.insert(backward.end(), forward.begin(), forward.end());
+
+	/* Only pairs next to a slot that changes hands can change */
+	for (size_t i = 0; i < slots.size(); i++) {
+		if (_pos[slots[i]] != backward[i]) {
+			if (pairs.empty() || pairs.back() != slots[i] - 1) { pairs.push_back(slots[i] - 1); }
+			pairs.push_back(slots[i]);
+		}
+	}
+	for (size_t i = 0; i < pairs.size(); i++) { _linked -= linked(pairs[i]); }
+	for (size_t i = 0; i < backward.size(); i++) {
+		_ord[backward[i]] = slots[i];
+		_pos[slots[i]] = backward[i];
+	}
+	for (size_t i = 0; i < pairs.size(); i++) { _linked += linked(pairs[i]); }
+}
+
+graphStatus OnlineGraph::status() const {
+	return order_status(_cyclic, _linked == (int) _pos.size() - 1);
+}
+
+std::ostream& operator<<(std::ostream& os, const OnlineGraph &graph) {
+	switch ( graph.status() ) {
+		case INCOHERENT:
+			return os << "Incoerente";
+
+		case INSUFFICIENT:
+			return os << "Insuficiente";
+
+		default: {
+			int i, size = graph._pos.size() - 1;
+			for ( i = 0; i < size; i++ ) {
+				os << graph._pos[i] << " ";
+			}
+			return os << graph._pos[i];
+		}
+	}
+}
+
+/* Feeds the input's edges to an OnlineGraph, printing its status after every
+** batch of them and the usual answer after the last one */
+void online(int num_v, int num_e, int batch) {
+	OnlineGraph g(num_v);
+
+	for (int e = 1; e <= num_e; e++) {
+		int num1, num2;
+
+		get_edge(&num1, &num2);
+		g.connect(new_vertex(num1), new_vertex(num2));
+
+		if (e % batch == 0 && e < num_e) {
+			static const char *words[] = { "Correto", "Incoerente", "Insuficiente" };
+			std::cout << e << " " << words[g.status()] << "\n";
+		}
+	}
+	Bench_Phase(BENCH_OUTPUT);
+	std::cout << g << std::endl;
 }
 
 /***************************** MAIN function **********************************/
-int main(void) {
+/* Usage: projpp [--online [batch]] < input, or ASA_SORT=online projpp < input */
+int main(int argc, char *argv[]) {
 	int num_v, num_e;
+	const char *mode = std::getenv("ASA_SORT");
+	bool is_online = argc > 1 && std::strcmp(argv[1], "--online") == 0;
+
+	Bench_Phase(BENCH_PARSE);
 	get_numbers(&num_v, &num_e);
 
+	if (is_online || (mode != NULL && std::strcmp(mode, "online") == 0)) {
+		int batch = argc > 2 ? std::atoi(argv[2]) : 0;
+
+		Bench_Phase(BENCH_SOLVE);
+		online(num_v, num_e, batch > 0 ? batch : num_e + 1);
+		return 0;
+	}
+
 	Graph g(num_v, num_e);
+	Bench_Phase(BENCH_SOLVE);
 	g.sort();
+	Bench_Phase(BENCH_OUTPUT);
 	std::cout << g << std::endl;
 
 	return 0;
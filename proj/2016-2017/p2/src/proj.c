@@ -1,8 +1,13 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+
+/* Shared libraries */
+#include "GraphFile.h"
+#include "Bench.h"
 
 /******** Shared structures ********/
-typedef unsigned char uint8_t;
 typedef size_t Cost;
 typedef size_t Vertex;
 
@@ -80,154 +85,219 @@ const char* graph_print_budget(Graph *g) {
 }
 
 /******** Sets ********/
-struct {
+typedef struct sets {
 	int *rank;
 	Vertex *parent;
 } Sets;
 
-void make_set(Vertex u) {
-	Sets.rank[u] = 0;
-	Sets.parent[u] = u;
+void make_set(Sets *sets, Vertex u) {
+	sets->rank[u] = 0;
+	sets->parent[u] = u;
 }
-void init_sets(size_t num_cities) {
+void init_sets(Sets *sets, size_t num_cities) {
 	Vertex city;
 
 	num_cities++;
-	Sets.rank   = malloc(num_cities * sizeof(*Sets.rank));
-	Sets.parent = malloc(num_cities * sizeof(*Sets.parent));
+	sets->rank   = malloc(num_cities * sizeof(*sets->rank));
+	sets->parent = malloc(num_cities * sizeof(*sets->parent));
 
     for (city = 0; city < num_cities; city++) {
-        make_set(city);
+        make_set(sets, city);
     }
 }
-void destroy_sets(void) {
-	free(Sets.rank); Sets.rank = NULL;
-    free(Sets.parent); Sets.parent = NULL;
+void destroy_sets(Sets *sets) {
+	free(sets->rank); sets->rank = NULL;
+    free(sets->parent); sets->parent = NULL;
 }
-Vertex find_set(Vertex u) {
-	if (u != Sets.parent[u]) { Sets.parent[u] = find_set(Sets.parent[u]); }
-	return Sets.parent[u];
+Vertex find_set(Sets *sets, Vertex u) {
+	if (u != sets->parent[u]) {
+		Bench_Count(BENCH_UF_COMPRESSIONS);
+		sets->parent[u] = find_set(sets, sets->parent[u]);
+	}
+	return sets->parent[u];
 }
-void merge_set(Vertex u, Vertex v) {
+void merge_set(Sets *sets, Vertex u, Vertex v) {
 	if (u == v) { return; }
 
-	if (Sets.rank[u] < Sets.rank[v]) { Sets.parent[u] = v; }
-	else if (Sets.rank[u] > Sets.rank[v]) { Sets.parent[v] = u; }
+	if (sets->rank[u] < sets->rank[v]) { sets->parent[u] = v; }
+	else if (sets->rank[u] > sets->rank[v]) { sets->parent[v] = u; }
 	else {
-		Sets.parent[v] = u;
-		Sets.rank[u]++;
+		sets->parent[v] = u;
+		sets->rank[u]++;
 	}
 }
 
 
 /******** Algorithm stuff ********/
-int comp_airports(const void *airport1, const void *airport2) {
-    Airport a1 = *(const Airport*) airport1;
-    Airport a2 = *(const Airport*) airport2;
+/* Sorts count items of the given size by the Cost at key_offset of each.
+** LSD radix sort, a byte at a time: linear in count and stable (as glibc's
+** merge-sorting qsort was), with one pass over the items per byte that isn't
+** the same for all of them. */
+#define RADIX_BITS 8
+#define RADIX_SIZE (1 << RADIX_BITS)
+#define radix_key(item) (*(const Cost*) ((item) + key_offset))
+#define radix_digit(key, d) (((key) >> ((d) * RADIX_BITS)) & (RADIX_SIZE - 1))
+
+void radix_sort(void *base, size_t count, size_t size, size_t key_offset) {
+	size_t hist[sizeof(Cost)][RADIX_SIZE];
+	unsigned char *src = base, *dst, *tmp;
+	size_t i, d;
+
+	if (count < 2) { return; }
+	dst = malloc(count * size);
+
+	/* Every byte's histogram in a single read */
+	memset(hist, 0, sizeof(hist));
+	for (i = 0; i < count; i++) {
+		Cost key = radix_key(src + i * size);
+		for (d = 0; d < sizeof(Cost); d++) { hist[d][radix_digit(key, d)]++; }
+	}
 
-    return a1.cost - a2.cost;
-}
-int comp_roads(const void *road1, const void *road2) {
-    Road r1 = *(const Road*) road1;
-    Road r2 = *(const Road*) road2;
+	for (d = 0; d < sizeof(Cost); d++) {
+		size_t digit, sum = 0;
 
-    return r1.cost - r2.cost;
+		if (hist[d][radix_digit(radix_key(src), d)] == count) { continue; }
+		for (digit = 0; digit < RADIX_SIZE; digit++) {
+			size_t here = hist[d][digit];
+			hist[d][digit] = sum;
+			sum += here;
+		}
+		for (i = 0; i < count; i++) {
+			unsigned char *item = src + i * size;
+			memcpy(dst + hist[d][radix_digit(radix_key(item), d)]++ * size, item, size);
+		}
+		tmp = src; src = dst; dst = tmp;
+	}
+
+	if (src != base) {
+		memcpy(base, src, count * size);
+		dst = src;
+	}
+	free(dst);
 }
 
-void mst_add_road(Road road, Budget *budget) {
+/* Both return whether the Road/Airport joined 2 sets */
+int mst_add_road(Sets *sets, Road road, Budget *budget) {
 	int city_cost = road.cost;
 	Vertex city_a = road.city1;
 	Vertex city_b = road.city2;
 
-	Vertex set_a = find_set(city_a);
-	Vertex set_b = find_set(city_b);
+	Vertex set_a = find_set(sets, city_a);
+	Vertex set_b = find_set(sets, city_b);
 
+	Bench_Add(BENCH_UF_FINDS, 2);
 	if (set_a != set_b) {
-		merge_set(set_a, set_b);
+		merge_set(sets, set_a, set_b);
 		budget->cost += city_cost;
 		budget->num_roads++;
+		return 1;
 	}
+	return 0;
 }
-void mst_add_airport(Airport airport, Budget *budget) {
+int mst_add_airport(Sets *sets, Airport airport, Budget *budget) {
 	int city_cost = airport.cost;
 	Vertex city = airport.city;
 	Vertex sky = 0;
 
-	Vertex set_a = find_set(sky);
-	Vertex set_b = find_set(city);
+	Vertex set_a = find_set(sets, sky);
+	Vertex set_b = find_set(sets, city);
 
+	Bench_Add(BENCH_UF_FINDS, 2);
 	if (set_a != set_b) {
-		merge_set(set_a, set_b);
+		merge_set(sets, set_a, set_b);
 		budget->cost += city_cost;
 		budget->num_airports++;
+		return 1;
 	}
+	return 0;
 }
 
-int can_add_road(Graph *g, size_t i_airports, size_t i_roads) {
-	return g->roads[i_roads].cost <= g->airports[i_airports].cost
-		&& i_roads < g->size_roads;
-}
-int can_add_airport(Graph *g, size_t i_airports, size_t i_roads) {
-	return g->roads[i_roads].cost > g->airports[i_airports].cost
-		&& i_airports < g->size_airports;
+/* Roads go first on ties. Either list may run out before the other */
+int next_is_road(Graph *g, size_t i_airports, size_t i_roads) {
+	return i_roads < g->size_roads
+		&& (i_airports >= g->size_airports || g->roads[i_roads].cost <= g->airports[i_airports].cost);
 }
 
-void min_span_tree(Graph *g, Budget *budget, uint8_t *visited) {
+/* Builds both MSTs, without airports and with them, in a single sweep over the
+** sorted Roads & Airports. Each stops taking edges once it spans its cities
+** (plus the sky, for the second), and the sweep stops once both do.
+** The second forest always joins at least what the first does, so a road the
+** first turns down (or any road, once it spans) is never looked up again. */
+void min_span_trees(Graph *g, Budget *roads, Budget *roads_airports) {
 	size_t i_airports = 0, i_roads = 0;
-
-	init_sets(g->num_cities);
-	while (i_roads < g->size_roads || i_airports < g->size_airports) {
-		if (can_add_road(g, i_airports, i_roads)) {
-			mst_add_road(g->roads[i_roads++], budget);
-		} else if (can_add_airport(g, i_airports, i_roads)) {
-			if (visited != NULL) {
-				mst_add_airport(g->airports[i_airports], budget);
-				visited[g->airports[i_airports].city] = 1;
+	size_t roads_left = g->num_cities - 1, all_left = g->num_cities;
+	Sets roads_sets, all_sets;
+
+	init_sets(&roads_sets, g->num_cities);
+	init_sets(&all_sets, g->num_cities);
+
+	while ((roads_left > 0 || all_left > 0)
+		&& (i_roads < g->size_roads || i_airports < g->size_airports)) {
+		if (next_is_road(g, i_airports, i_roads)) {
+			Road road = g->roads[i_roads++];
+			if (roads_left > 0 && mst_add_road(&roads_sets, road, roads)) {
+				roads_left--;
+				if (all_left > 0) { all_left -= mst_add_road(&all_sets, road, roads_airports); }
 			}
-			i_airports++;
 		} else {
-			break; /* Nothing works and code somehow fell through here */
+			Airport airport = g->airports[i_airports++];
+			if (all_left > 0) { all_left -= mst_add_airport(&all_sets, airport, roads_airports); }
 		}
 	}
+
+	destroy_sets(&roads_sets);
+	destroy_sets(&all_sets);
 }
 
 void kruskal(Graph *g) {
 	Budget roads = { 0, 0, 0 }, roads_airports = { 0, 0, 0 };
-	uint8_t *visited = calloc(g->num_cities+1, sizeof(uint8_t));
-	Vertex city;
-
-    init_sets(g->num_cities);
 
-    qsort(g->airports, g->num_airports, sizeof(Airport), comp_airports);
-    qsort(g->roads, g->num_roads, sizeof(Road), comp_roads);
+    radix_sort(g->airports, g->num_airports, sizeof(Airport), offsetof(Airport, cost));
+    radix_sort(g->roads, g->num_roads, sizeof(Road), offsetof(Road, cost));
 
-	/* First MST without airports */
-    min_span_tree(g, &roads, NULL);
-
-	/* Second MST with airports*/
-	min_span_tree(g, &roads_airports, visited);
+	/* Both MSTs, without airports and with them */
+	min_span_trees(g, &roads, &roads_airports);
 
+	/* The cheapest that spans every city. If neither does, some city is cut off */
 	if (roads.num_roads == g->num_cities-1) {
 		g->budget = (roads.cost <= roads_airports.cost) ? roads : roads_airports;
 	} else {
 		g->budget = roads_airports;
-
-		for (city = 1; city <= g->num_cities; city++) {
-			if (!visited[city]) {
-				g->status = INSUFFICIENT;
-				break;
-			}
+		if (roads_airports.num_roads + roads_airports.num_airports < g->num_cities) {
+			g->status = INSUFFICIENT;
 		}
 	}
-
-	free(visited); visited = NULL;
-    destroy_sets();
 }
 
 /*** MAIN ***/
-#define get_number(a) scanf("%zu", a)
-#define get_2_numbers(a, b) scanf("%zu %zu", a, b)
-#define get_3_numbers(a, b, c) scanf("%zu %zu %zu", a, b, c)
+/* Reads the next value of a section, from either text or binary input */
+size_t get_value(int id) {
+	size_t val;
+	int num;
+
+	if (GraphFile_Stdin() == NULL) {
+		Input_Size(Input_Stdin(), &val);
+		return val;
+	}
+	GraphFile_Next(GraphFile_Stdin(), id, &num);
+	return num;
+}
+void get_road(Road *road) {
+	int u, v, w;
+
+	if (GraphFile_Stdin() == NULL) {
+		road->city1 = get_value(GF_TARGETS);
+		road->city2 = get_value(GF_TARGETS);
+		road->cost  = get_value(GF_WEIGHTS);
+		return;
+	}
+	GraphFile_NextEdge(GraphFile_Stdin(), &u, &v, &w);
+	road->city1 = u;
+	road->city2 = v;
+	road->cost  = w;
+}
+#define get_number(a) (*(a) = get_value(GF_COUNTS))
+#define get_2_numbers(a, b) (*(a) = get_value(GF_AIRPORTS), *(b) = get_value(GF_AIRPORTS))
 
 void graph_from_input(Graph *g) {
     size_t num_cities, i;
@@ -247,16 +317,19 @@ void graph_from_input(Graph *g) {
     set_num_roads(g, g->num_roads);
     for (i = 0; i < g->num_roads; i++) {
 		Road road;
-        get_3_numbers(&road.city1, &road.city2, &road.cost);
+        get_road(&road);
         graph_insert_road(g, road);
     }
 }
 
 int main() {
     Graph g;
+	Bench_Phase(BENCH_PARSE);
 	graph_from_input(&g);
 
+	Bench_Phase(BENCH_SOLVE);
     kruskal(&g);
+	Bench_Phase(BENCH_OUTPUT);
 	printf("%s\n", graph_print_budget(&g));
 
 	destroy_graph(&g);
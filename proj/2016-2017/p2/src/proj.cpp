@@ -4,16 +4,51 @@
 *******************************************************************************/
 
 /* Libraries. Only the bare minimum, no need for clutter */
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <algorithm>
 #include <vector>
+#include <atomic>
+#include <thread>
+#include <set>
+#include <queue>
+#include <unordered_map>
+#include <fcntl.h>
+
+/* Shared libraries */
+#include "GraphFile.h"
+#include "Bench.h"
+#include "Threads.h"
 
 using namespace std;
 
 /****************************** auxy functions *********************************/
-void get_numbers(size_t &a) { cin >> a; }
-void get_numbers(size_t &a, size_t &b) { cin >> a >> b; }
-void get_numbers(size_t &a, size_t &b, size_t &c) { cin >> a >> b >> c; }
+/* Reads the next value of a section, from either text or binary input */
+size_t get_value(int id) {
+	size_t val;
+	int num;
+
+	if (GraphFile_Stdin() == NULL) {
+		Input_Size(Input_Stdin(), &val);
+		return val;
+	}
+	GraphFile_Next(GraphFile_Stdin(), id, &num);
+	return num;
+}
+void get_numbers(size_t &a) { a = get_value(GF_COUNTS); }
+void get_numbers(size_t &a, size_t &b) { a = get_value(GF_AIRPORTS); b = get_value(GF_AIRPORTS); }
+void get_numbers(size_t &a, size_t &b, size_t &c) {
+	if (GraphFile_Stdin() == NULL) {
+		a = get_value(GF_TARGETS); b = get_value(GF_TARGETS); c = get_value(GF_WEIGHTS);
+		return;
+	}
+	int u, v, w;
+	GraphFile_NextEdge(GraphFile_Stdin(), &u, &v, &w);
+	a = u; b = v; c = w;
+}
 
 /* Status */
 enum Status {
@@ -26,8 +61,121 @@ enum Status {
 
 /******************** Data structures and their "methods" *********************/
 
+/* LSD radix sort on key(item), a byte at a time from byte "from" up: linear in
+** the number of items, with one pass over them per byte that isn't the same
+** for all of them */
+#define RADIX_BITS 8
+#define RADIX_SIZE (1 << RADIX_BITS)
+#define radix_digit(key, d) (((key) >> ((d) * RADIX_BITS)) & (RADIX_SIZE - 1))
+
+template <typename T, typename Key>
+void radix_sort(T *items, size_t size, Key key, size_t from = 0) {
+	if (size < 2) { return; }
+
+	const size_t digits = sizeof(key(items[0]));
+	vector<size_t> hist(digits * RADIX_SIZE, 0);
+	vector<T> scratch(size);
+	T *src = items, *dst = scratch.data();
+
+	/* Every byte's histogram in a single read */
+	for ( size_t i = 0; i < size; i++ ) {
+		uint64_t k = key(items[i]);
+		for ( size_t d = from; d < digits; d++ ) { hist[d * RADIX_SIZE + radix_digit(k, d)]++; }
+	}
+
+	for ( size_t d = from; d < digits; d++ ) {
+		size_t *count = &hist[d * RADIX_SIZE], sum = 0;
+
+		if (count[radix_digit(key(items[0]), d)] == size) { continue; }
+		for ( size_t digit = 0; digit < RADIX_SIZE; digit++ ) {
+			size_t here = count[digit];
+			count[digit] = sum;
+			sum += here;
+		}
+		for ( size_t i = 0; i < size; i++ ) {
+			dst[count[radix_digit(key(src[i]), d)]++] = src[i];
+		}
+		std::swap(src, dst);
+	}
+	if (src != items) { copy(src, src + size, items); }
+}
+
+#ifdef ASA_COMPACT
+/*
+** Compact layout (make COMPACT=1), for fewer than 2^32 edges and cities, and
+** costs below 2^31. Edges are kept as struct-of-arrays: the sort only moves
+** packed 64-bit keys, the sort key above the edge's place in the range being
+** sorted, and the cities are gathered into sorted order once it's done.
+** Union-find ranks (at most log2 of the city count) are bytes.
+** An input past those limits is refused as it's read.
+*/
+#define COMPACT_MAX_EDGES  0xFFFFFFFFULL
+#define COMPACT_MAX_CITIES 0xFFFFFFFEULL  /* So that city <= num_cities still ends */
+#define COMPACT_MAX_COST   0x7FFFFFFFULL
+
+void compact_refuse() {
+	cerr << "Input too large for a COMPACT=1 build." << endl;
+	exit(EXIT_FAILURE);
+}
+
+/* Vertex structure */
+typedef uint32_t Vertex;
+typedef unsigned char Rank;
+Vertex new_vertex(size_t val) {
+	if (val > COMPACT_MAX_CITIES) { compact_refuse(); }
+	return val;
+}
+
+/* Edge Structure */
+class Edges {
+	private:
+		vector<uint64_t> _keys;  /* _keys[Edge] = key << 32 | place */
+		vector<Vertex> _city_a;  /* _city_a[Edge] = Vertex */
+		vector<Vertex> _city_b;  /* _city_b[Edge] = Vertex */
+
+	public:
+		~Edges();
+
+		size_t size() const { return _keys.size(); }
+		uint64_t key(size_t e) const { return _keys[e] >> 32; }
+		size_t cost(size_t e) const { return _keys[e] >> 33; }
+		Vertex city_a(size_t e) const { return _city_a[e]; }
+		Vertex city_b(size_t e) const { return _city_b[e]; }
+		void reserve(size_t val) { _keys.reserve(val); _city_a.reserve(val); _city_b.reserve(val); }
+		void clear() { _keys.clear(); _city_a.clear(); _city_b.clear(); }
+
+		void push(Vertex city_a, Vertex city_b, size_t cost) {
+			if (cost > COMPACT_MAX_COST || size() >= COMPACT_MAX_EDGES) { compact_refuse(); }
+			_keys.push_back((uint64_t) (cost << 1 | (city_a == AIRPORT)) << 32 | size());
+			_city_a.push_back(city_a);
+			_city_b.push_back(city_b);
+		}
+
+		void swap(size_t e, size_t f) {
+			std::swap(_keys[e], _keys[f]);
+			std::swap(_city_a[e], _city_a[f]);
+			std::swap(_city_b[e], _city_b[f]);
+		}
+
+		/* Sorts edges [from, to): cost first, with roads before airports of the
+		** same cost */
+		void sort(size_t from, size_t to) {
+			vector<Vertex> sorted(to - from);
+
+			/* Keys then go in place order, so the place bytes need no pass */
+			for ( size_t e = from; e < to; e++ ) { _keys[e] = _keys[e] >> 32 << 32 | (e - from); }
+			radix_sort(_keys.data() + from, to - from, [](uint64_t key) { return key; }, 4);
+
+			for ( size_t e = from; e < to; e++ ) { sorted[e - from] = _city_a[from + (uint32_t) _keys[e]]; }
+			copy(sorted.begin(), sorted.end(), _city_a.begin() + from);
+			for ( size_t e = from; e < to; e++ ) { sorted[e - from] = _city_b[from + (uint32_t) _keys[e]]; }
+			copy(sorted.begin(), sorted.end(), _city_b.begin() + from);
+		}
+};
+#else
 /* Vertex structure */
 typedef size_t Vertex;
+typedef int Rank;
 Vertex new_vertex(size_t val) { return val; }
 
 /* Edge Structure */
@@ -35,6 +183,48 @@ typedef pair< size_t, pair<Vertex, Vertex> > Edge;
 Edge new_edge(Vertex city_a, Vertex city_b, size_t cost) {
 	return make_pair(cost, make_pair(city_a, city_b));
 }
+/* Cost first, with roads before airports of the same cost */
+uint64_t edge_key(const Edge &edge) { return edge.first << 1 | (edge.second.first == AIRPORT); }
+
+class Edges {
+	private:
+		vector<Edge> _edges;
+
+	public:
+		~Edges();
+
+		size_t size() const { return _edges.size(); }
+		uint64_t key(size_t e) const { return edge_key(_edges[e]); }
+		size_t cost(size_t e) const { return _edges[e].first; }
+		Vertex city_a(size_t e) const { return _edges[e].second.first; }
+		Vertex city_b(size_t e) const { return _edges[e].second.second; }
+		void reserve(size_t val) { _edges.reserve(val); }
+		void clear() { _edges.clear(); }
+
+		void push(Vertex city_a, Vertex city_b, size_t cost) {
+			_edges.push_back(new_edge(city_a, city_b, cost));
+		}
+
+		void swap(size_t e, size_t f) { std::swap(_edges[e], _edges[f]); }
+
+		/* Sorts edges [from, to) by key. Kruskal takes the same number of each
+		** kind whatever the order within a key. */
+		void sort(size_t from, size_t to) {
+			radix_sort(_edges.data() + from, to - from, edge_key);
+		}
+};
+#endif
+Edges::~Edges() { /* Nothing here */ }
+
+/* Moves the edges in [from, to) that pass to the front, keeping their order.
+** Returns where the rest start. */
+template <typename Pred>
+size_t partition(Edges &edges, size_t from, size_t to, Pred pass) {
+	for ( size_t e = from; e < to; e++ ) {
+		if (pass(e)) { edges.swap(from++, e); }
+	}
+	return from;
+}
 
 /* Project Budget Structure */
 typedef struct {
@@ -42,17 +232,804 @@ typedef struct {
 	size_t num_roads, num_airports;
 } Budget;
 
-/* Compare Edges */
-struct LowerEdge {
-	bool operator()(const Edge& edge_a, const Edge& edge_b) const {
+/* Software prefetch, where the compiler has one */
+#ifdef __GNUC__
+#define prefetch(addr) __builtin_prefetch(addr)
+#else
+#define prefetch(addr) ((void) (addr))
+#endif
+
+/* Disjoint Sets Structure: union by rank & path halving */
+class Sets {
+	private:
+		Rank *_rank;
+		Vertex *_parent;
+
+	public:
+		Sets(size_t size) {
+			_rank = new Rank[size];
+			_parent = new Vertex[size];
+			for ( Vertex u = 0; u < size; u++ ) {
+				make_set(u);
+			}
+		}
+		~Sets() {
+			delete [] _rank;
+			delete [] _parent;
+		}
+
+		void make_set(Vertex u) {
+			_rank[u] = 0;
+			_parent[u] = u;
+		}
+		/* Path halving: each node on the way up skips to its grandparent */
+		Vertex find_set(Vertex u) {
+			while (u != _parent[u]) {
+				_parent[u] = _parent[_parent[u]];
+				u = _parent[u];
+			}
+			return u;
+		}
+		/* Starts loading u's parent into cache, ahead of a find */
+		void touch(Vertex u) const { prefetch(&_parent[u]); }
+		void merge_set(Vertex u, Vertex v) {
+			if (u == v) { return; }
+
+			if (_rank[u] < _rank[v]) { _parent[u] = v; }
+			else if (_rank[u] > _rank[v]) { _parent[v] = u; }
+			else {
+				_parent[v] = u;
+				_rank[u]++;
+			}
+		}
+		/* Joins u's and v's sets. Returns false if they were the same */
+		bool join(Vertex u, Vertex v) {
+			Vertex set_u = find_set(u);
+			Vertex set_v = find_set(v);
+
+			merge_set(set_u, set_v);
+			return set_u != set_v;
+		}
+};
+
+/* Both Minimum Spanning Forests being grown, without airports and with them.
+** Each stops taking edges once it spans its cities (plus the sky, for the
+** second). The second always joins at least what the first does, so a road
+** the first turns down (or any road, once it spans) is of no use to either. */
+class Forests {
+	private:
+		Sets _roads_sets, _all_sets;
+		size_t _roads_left, _all_left;
+		Budget _roads, _roads_airports;
+
+	public:
+		Forests(size_t num_cities);
+		~Forests();
+
+		/* Class attribute methods */
+		const Budget &roads()          const { return _roads; }
+		const Budget &roads_airports() const { return _roads_airports; }
+		bool done() const { return _roads_left == 0 && _all_left == 0; }
+
+		/* Class functional methods */
+		bool wanted(Vertex city_a, Vertex city_b) {
+			if ( city_a != AIRPORT ) {
+				return _roads_left > 0 && _roads_sets.find_set(city_a) != _roads_sets.find_set(city_b);
+			}
+			return _all_left > 0 && _all_sets.find_set(city_a) != _all_sets.find_set(city_b);
+		}
+		/* Starts loading what offering the edge will look at first: a road's
+		** ends in the forest without airports (the other only sees the few it
+		** takes), an airport's city in the one with them */
+		void touch(Vertex city_a, Vertex city_b) const {
+			if ( city_a != AIRPORT ) {
+				if ( _roads_left > 0 ) { _roads_sets.touch(city_a); _roads_sets.touch(city_b); }
+			} else if ( _all_left > 0 ) {
+				_all_sets.touch(city_b);
+			}
+		}
+		void add(Vertex city_a, Vertex city_b, size_t city_cost);
+		void take(Vertex city_a, size_t city_cost, bool with_airports);
+};
+
+Forests::Forests(size_t num_cities)
+	: _roads_sets(num_cities + 1), _all_sets(num_cities + 1),
+	  _roads_left(num_cities - 1), _all_left(num_cities),
+	  _roads(), _roads_airports() { }
+Forests::~Forests() { /* Nothing here */ }
+
+/* Offers the next edge, in sorted order, to both forests */
+void Forests::add(Vertex city_a, Vertex city_b, size_t city_cost) {
+	if ( city_a != AIRPORT ) {
+		if ( _roads_left == 0 || !_roads_sets.join(city_a, city_b) ) { return; }
+		take(city_a, city_cost, false);
+	}
+
+	if ( _all_left > 0 && _all_sets.join(city_a, city_b) ) {
+		take(city_a, city_cost, true);
+	}
+}
+
+/* Adds an edge known to join one of the forests (with airports or without) */
+void Forests::take(Vertex city_a, size_t city_cost, bool with_airports) {
+	Budget &budget = with_airports ? _roads_airports : _roads;
+
+	budget.cost += city_cost;
+	if (city_a != AIRPORT) {
+		budget.num_roads++;
+	} else {
+		budget.num_airports++;
+	}
+
+	if (with_airports) {
+		_all_left--;
+	} else {
+		_roads_left--;
+	}
+}
+
+/* Ways to grow the forests: sort every edge, Filter-Kruskal, Borůvka, merge
+** sorted runs spilled to disk, or Prim. AUTO picks one by density. */
+enum Engine {
+	AUTO = 0,
+	KRUSKAL,
+	FILTER_KRUSKAL,
+	BORUVKA,
+	EXTERNAL,
+	PRIM
+};
+
+/* AUTO takes Filter-Kruskal once there are DENSE_EDGES edges per city or
+** more, Kruskal otherwise. Sorting is linear (radix), so Prim's 2 arcs per edge
+** & random heap accesses don't pay off at any density: it's never picked. */
+#define DENSE_EDGES 4
+
+/* Kruskal offers edges in blocks this big, fetching the next one's meanwhile */
+#define KRUSKAL_BLOCK 32
+
+/* Filter-Kruskal sorts ranges this small outright, as it does those split more
+** than 2 log2(edges) times already (introsort's bound) */
+#define FILTER_MIN 1024
+
+/* External Kruskal keeps up to RUN_EDGES edges in memory (unless told
+** otherwise), sorts them and spills them to a temporary file as a run. Runs
+** are then merged MERGE_BLOCK edges at a time each, straight into the
+** forests. MERGE_WAYS runs of the same level are merged into one run of the
+** next level as soon as they pile up, to spare files.
+** That bounds the solver's own memory to O(V) plus the buffers, not the input
+** text's: Input_Open maps a regular file (clean pages the kernel may drop, but
+** they count as resident once read) and reads a pipe whole into memory. */
+#define RUN_EDGES   (1 << 20)
+#define MERGE_BLOCK (1 << 12)
+#define MERGE_WAYS  64
+
+/* An edge as spilled to a run */
+struct Spilled {
+	uint64_t key;      /* cost << 1 | airport */
+	Vertex city_a, city_b;
+};
+
+/* A run being merged, a block at a time */
+struct Run {
+	FILE *file;
+	vector<Spilled> block;
+	size_t next;
+
+	bool refill() {
+		block.resize(MERGE_BLOCK);
+		block.resize(fread(block.data(), sizeof(Spilled), MERGE_BLOCK, file));
+		next = 0;
+		return !block.empty();
+	}
+};
+
+/* Borůvka runs on Threads_Count() threads, splitting a pass across threads
+** only once it covers BORUVKA_PARALLEL_MIN edges or vertices */
+#define BORUVKA_PARALLEL_MIN (1 << 12)
+#define NO_EDGE ((size_t) -1)
+
+/* Borůvka state, shared by every thread. The union-find is lock-free: roots
+** are linked with a CAS, always under the smaller id (so the sky stays a
+** root), and finds split paths as they go. */
+struct Boruvka {
+	unsigned threads;
+	vector< atomic<Vertex> > parent;
+	vector< atomic<size_t> > best;       /* best[root] = lightest Edge out, or NO_EDGE */
+	vector<size_t> alive;                /* Edges that may still join 2 components */
+	vector< vector<size_t> > kept;       /* kept[thread]  = alive Edges it saw */
+	vector< vector<size_t> > taken;      /* taken[thread] = Edges it linked */
+
+	Boruvka(size_t size, unsigned num_threads)
+		: threads(num_threads), parent(size), best(size), kept(num_threads), taken(num_threads) {}
+	~Boruvka();
+
+	void make_sets() {
+		for ( Vertex u = 0; u < parent.size(); u++ ) { parent[u].store(u, memory_order_relaxed); }
+	}
+	Vertex find_set(Vertex u) {
+		for (;;) {
+			Vertex up = parent[u].load(), root = parent[up].load();
+			if (up == root) { return up; }
+			parent[u].compare_exchange_weak(up, root);
+			u = up;
+		}
+	}
+	/* Returns false if u & v were in the same set already */
+	bool join(Vertex u, Vertex v) {
+		for (;;) {
+			u = find_set(u);
+			v = find_set(v);
+			if (u == v) { return false; }
+			if (u < v) { std::swap(u, v); }
+
+			Vertex root = u;
+			if (parent[u].compare_exchange_strong(root, v)) { return true; }
+		}
+	}
+};
+Boruvka::~Boruvka() { /* Nothing here */ }
+
+/* Prim's heap is HEAP_WAYS-ary: shallower than a binary one, for the many
+** decrease-keys of dense graphs */
+#define HEAP_WAYS 4
+#define NO_SLOT   ((size_t) -1)
+#define REACHED   ((size_t) -2)
+
+/* Edges around each city, as compressed rows of arcs. Arcs carry the key, so
+** a row is read through without going back to the edges. */
+struct Arc {
+	uint64_t key;
+	size_t edge;
+	Vertex city;    /* At the other end */
+};
+
+class Adjacency {
+	private:
+		vector<size_t> _first;   /* _first[Vertex] = Slot of its first arc */
+		vector<Arc> _arcs;
+
+	public:
+		/* Takes the edges that keep passes */
+		template <typename Pred>
+		Adjacency(const Edges &edges, size_t num_vertices, Pred keep) : _first(num_vertices + 2, 0) {
+			for ( size_t e = 0; e < edges.size(); e++ ) {
+				if (keep(e)) { _first[edges.city_a(e)]++; _first[edges.city_b(e)]++; }
+			}
+			for ( size_t u = 1; u <= num_vertices + 1; u++ ) { _first[u] += _first[u-1]; }
+
+			_arcs.resize(_first[num_vertices + 1]);
+			for ( size_t e = edges.size(); e-- > 0; ) {
+				if (!keep(e)) { continue; }
+				Arc to_b = { edges.key(e), e, edges.city_b(e) }, to_a = { edges.key(e), e, edges.city_a(e) };
+				_arcs[--_first[edges.city_a(e)]] = to_b;
+				_arcs[--_first[edges.city_b(e)]] = to_a;
+			}
+		}
+		~Adjacency();
+
+		size_t first(Vertex u) const { return _first[u]; }
+		size_t last(Vertex u)  const { return _first[u+1]; }
+		const Arc &arc(size_t slot) const { return _arcs[slot]; }
+};
+Adjacency::~Adjacency() { /* Nothing here */ }
+
+/* Indexed min-heap of the cities Prim is about to reach, by the lightest edge
+** seen to each: (key, Edge), like Kruskal's stable order */
+class Heap {
+	private:
+		struct Item {
+			uint64_t key;
+			size_t edge;
+			Vertex city;
+		};
+		vector<Item> _items;
+		vector<size_t> _slot;    /* _slot[Vertex] = Slot, NO_SLOT or REACHED */
+
+		static bool lighter(const Item &a, const Item &b) {
+			return a.key < b.key || (a.key == b.key && a.edge < b.edge);
+		}
+		void place(size_t slot, const Item &item) {
+			_items[slot] = item;
+			_slot[item.city] = slot;
+		}
+		void sift_up(size_t slot, Item item);
+		void sift_down(size_t slot, Item item);
+
+	public:
+		Heap(size_t size) : _slot(size, NO_SLOT) { }
+		~Heap();
+
+		bool empty() const { return _items.empty(); }
+		bool reached(Vertex city) const { return _slot[city] == REACHED; }
+
+		/* Offers an edge to city, if it's lighter than the ones seen */
+		void offer(Vertex city, uint64_t key, size_t edge) {
+			size_t slot = _slot[city];
+			Item item = { key, edge, city };
+
+			if (slot == REACHED) { return; }
+			if (slot == NO_SLOT) {
+				_items.push_back(item);
+				sift_up(_items.size() - 1, item);
+			} else if (lighter(item, _items[slot])) {
+				sift_up(slot, item);
+			}
+		}
+		/* Takes the city closest to the tree out, as reached. Returns the edge
+		** it was reached by. */
+		size_t pop(Vertex &city) {
+			Item top = _items[0], item = _items.back();
+
+			_items.pop_back();
+			if (!_items.empty()) { sift_down(0, item); }
+			_slot[top.city] = REACHED;
+			city = top.city;
+			return top.edge;
+		}
+};
+Heap::~Heap() { /* Nothing here */ }
+
+void Heap::sift_up(size_t slot, Item item) {
+	while (slot > 0) {
+		size_t up = (slot - 1) / HEAP_WAYS;
+		if (!lighter(item, _items[up])) { break; }
+		place(slot, _items[up]);
+		slot = up;
+	}
+	place(slot, item);
+}
+
+void Heap::sift_down(size_t slot, Item item) {
+	for (;;) {
+		size_t child = slot * HEAP_WAYS + 1, end = min(child + HEAP_WAYS, _items.size()), best = child;
+		if (child >= _items.size()) { break; }
+		for ( size_t c = child + 1; c < end; c++ ) {
+			if (lighter(_items[c], _items[best])) { best = c; }
+		}
+		if (!lighter(_items[best], item)) { break; }
+		place(slot, _items[best]);
+		slot = best;
+	}
+	place(slot, item);
+}
+
+/* Link-cut trees (Sleator & Tarjan) over a forest whose edges are nodes of
+** their own, between their 2 ends, so that the heaviest node on a path is its
+** heaviest edge. Edges weigh (key, Edge), like Kruskal's stable order. Node 0
+** is nil. */
+class LinkCut {
+	private:
+		struct Node {
+			size_t child[2], parent;
+			size_t heaviest;     /* Heaviest edge node in this splay subtree, or 0 */
+			uint64_t key;
+			size_t edge;         /* NO_EDGE for vertex nodes */
+			bool flip;
+		};
+		vector<Node> _nodes;
+		vector<size_t> _path;    /* splay's scratch */
+
+		bool is_splay_root(size_t x) const {
+			size_t up = _nodes[x].parent;
+			return up == 0 || (_nodes[up].child[0] != x && _nodes[up].child[1] != x);
+		}
+		size_t heavier(size_t x, size_t y) const {
+			if (x == 0 || y == 0) { return x + y; }
+			const Node &a = _nodes[x], &b = _nodes[y];
+			return (a.key > b.key || (a.key == b.key && a.edge > b.edge)) ? x : y;
+		}
+		void push(size_t x);
+		void pull(size_t x);
+		void rotate(size_t x);
+		void splay(size_t x);
+		void access(size_t x);
+		void make_root(size_t x);
+
+	public:
+		LinkCut(size_t size);
+		~LinkCut();
+
+		void set_edge(size_t x, uint64_t key, size_t edge) {
+			_nodes[x].key = key;
+			_nodes[x].edge = edge;
+			_nodes[x].heaviest = edge == NO_EDGE ? 0 : x;
+		}
+		size_t edge(size_t x) const { return _nodes[x].edge; }
+
+		size_t find_root(size_t x);
+		void hang(size_t x, size_t up) { _nodes[x].parent = up; }
+		void link(size_t x, size_t y);
+		void cut(size_t x, size_t y);
+		size_t heaviest(size_t x, size_t y);
+};
+
+LinkCut::LinkCut(size_t size) : _nodes(size) {
+	for ( size_t x = 0; x < size; x++ ) {
+		_nodes[x].child[0] = _nodes[x].child[1] = _nodes[x].parent = 0;
+		_nodes[x].flip = false;
+		set_edge(x, 0, NO_EDGE);
+	}
+}
+LinkCut::~LinkCut() { /* Nothing here */ }
+
+void LinkCut::push(size_t x) {
+	Node &node = _nodes[x];
+	if (!node.flip) { return; }
+
+	std::swap(node.child[0], node.child[1]);
+	for ( size_t c : node.child ) {
+		if (c != 0) { _nodes[c].flip = !_nodes[c].flip; }
+	}
+	node.flip = false;
+}
+
+void LinkCut::pull(size_t x) {
+	Node &node = _nodes[x];
+	size_t own = node.edge == NO_EDGE ? 0 : x;
+	node.heaviest = heavier(own, heavier(_nodes[node.child[0]].heaviest, _nodes[node.child[1]].heaviest));
+}
+
+void LinkCut::rotate(size_t x) {
+	size_t up = _nodes[x].parent, top = _nodes[up].parent;
+	int side = _nodes[up].child[1] == x;
+	size_t moved = _nodes[x].child[!side];
+
+	if (!is_splay_root(up)) { _nodes[top].child[_nodes[top].child[1] == up] = x; }
+	_nodes[x].parent = top;
+
+	_nodes[x].child[!side] = up;
+	_nodes[up].parent = x;
+	_nodes[up].child[side] = moved;
+	if (moved != 0) { _nodes[moved].parent = up; }
+
+	pull(up);
+	pull(x);
+}
+
+void LinkCut::splay(size_t x) {
+
+	/* Pending flips come down from the top of x's splay tree first */
+	_path.assign(1, x);
+	for ( size_t y = x; !is_splay_root(y); y = _nodes[y].parent ) { _path.push_back(_nodes[y].parent); }
+	while (!_path.empty()) { push(_path.back()); _path.pop_back(); }
+
+	while (!is_splay_root(x)) {
+		size_t up = _nodes[x].parent, top = _nodes[up].parent;
+		if (!is_splay_root(up)) {
+			bool zigzig = (_nodes[up].child[1] == x) == (_nodes[top].child[1] == up);
+			rotate(zigzig ? up : x);
+		}
+		rotate(x);
+	}
+}
+
+/* Makes the path from x's root down to x a splay tree of its own, x on top */
+void LinkCut::access(size_t x) {
+	for ( size_t below = 0, y = x; y != 0; below = y, y = _nodes[y].parent ) {
+		splay(y);
+		_nodes[y].child[1] = below;
+		pull(y);
+	}
+	splay(x);
+}
+
+void LinkCut::make_root(size_t x) {
+	access(x);
+	_nodes[x].flip = !_nodes[x].flip;
+	push(x);
+}
+
+size_t LinkCut::find_root(size_t x) {
+	access(x);
+	for ( push(x); _nodes[x].child[0] != 0; push(x) ) { x = _nodes[x].child[0]; }
+	splay(x);
+	return x;
+}
+
+/* x & y must be in different trees */
+void LinkCut::link(size_t x, size_t y) {
+	make_root(x);
+	_nodes[x].parent = y;
+}
+
+/* x & y must be neighbours */
+void LinkCut::cut(size_t x, size_t y) {
+	make_root(x);
+	access(y);
+	_nodes[y].child[0] = 0;
+	_nodes[x].parent = 0;
+	pull(y);
+}
+
+/* Heaviest edge node on the path from x to y, which must be in the same tree */
+size_t LinkCut::heaviest(size_t x, size_t y) {
+	make_root(x);
+	access(y);
+	return _nodes[y].heaviest;
+}
+
+/* Edge states in a DynamicTree */
+enum Role {
+	OUT = 0,  /* Not one of its edges */
+	SPARE,    /* Left out of the tree */
+	TREE
+};
+
+/*
+** One of the MSTs (with airports or without), kept up to date as edges come &
+** go. An edge that comes in replaces the heaviest one on the cycle it closes
+** (found on the link-cut trees), if it's lighter. A tree edge that goes is
+** replaced by the lightest spare between its 2 halves: the smaller half is
+** marked, walking both at once, and since every such spare is heavier, the
+** search starts right after the edge, by position among the edges Kruskal
+** sorted, and in a set among the ones that came after.
+** So an edge that comes, or a spare that goes, takes O(log n) amortized, but
+** a tree edge that goes takes as long as the walk & that search: O(E) at
+** worst, since nothing indexes the spares by the halves they join.
+*/
+class DynamicTree {
+	private:
+		const Edges &_edges;
+		size_t _num_cities;
+		bool _with_airports;
+		size_t _sorted;                /* Edges below this are sorted */
+		LinkCut _links;
+		vector<size_t> _free;          /* Free edge nodes */
+		vector<unsigned char> _role;   /* _role[Edge] = Role */
+		vector<size_t> _node;          /* _node[Edge] = link-cut node, if TREE */
+		set< pair<uint64_t, size_t> > _spares;  /* Spare (key, Edge) past _sorted */
+		vector< vector<size_t> > _adjacent;     /* _adjacent[Vertex] = its TREE Edges */
+		vector<size_t> _mark;          /* _mark[Vertex] = _stamp + half, once walked */
+		size_t _stamp;
+		vector<size_t> _walk[2];       /* Walks over both halves */
+		Budget _budget;
+
+		size_t city_node(Vertex city) const { return city + 1; }
+		Vertex other(size_t e, Vertex city) const {
+			return _edges.city_a(e) == city ? _edges.city_b(e) : _edges.city_a(e);
+		}
+		bool lighter(size_t e, size_t f) const;
+		bool joins(size_t e);
+		size_t new_node(size_t e);
+		void take(size_t e);
+		void drop(size_t e);
+		void link(size_t e);
+		void cut(size_t e);
+		void spare(size_t e);
+		void unspare(size_t e);
+		size_t mark_smaller(Vertex city_a, Vertex city_b);
+
+	public:
+		DynamicTree(const Edges &edges, size_t num_cities, bool with_airports);
+		~DynamicTree();
+
+		const Budget &budget() const { return _budget; }
+		void build(const vector<bool> &current);
+		void insert(size_t e);
+		void erase(size_t e);
+};
 
-		if (edge_a.first < edge_b.first) { return true; }
-		if (edge_a.first > edge_b.first) { return false; }
-		if (edge_a.second.first > edge_b.second.first) { return true; }
-		return false;
+DynamicTree::DynamicTree(const Edges &edges, size_t num_cities, bool with_airports)
+	: _edges(edges), _num_cities(num_cities), _with_airports(with_airports), _sorted(edges.size()),
+	  _links(2 * (num_cities + 1) + 1), _role(edges.size(), OUT), _node(edges.size(), 0),
+	  _adjacent(num_cities + 1), _mark(num_cities + 1, 0), _stamp(0), _budget() {
 
+	/* Nodes 1 to num_cities + 1 are the sky & cities, the rest tree edges */
+	for ( size_t x = 2 * (num_cities + 1); x > num_cities + 1; x-- ) { _free.push_back(x); }
+}
+DynamicTree::~DynamicTree() { /* Nothing here */ }
+
+bool DynamicTree::lighter(size_t e, size_t f) const {
+	return _edges.key(e) < _edges.key(f) || (_edges.key(e) == _edges.key(f) && e < f);
+}
+
+/* Whether e's cities are in different trees */
+bool DynamicTree::joins(size_t e) {
+	return _links.find_root(city_node(_edges.city_a(e))) != _links.find_root(city_node(_edges.city_b(e)));
+}
+
+size_t DynamicTree::new_node(size_t e) {
+	size_t x = _free.back();
+
+	_free.pop_back();
+	_links.set_edge(x, _edges.key(e), e);
+	_node[e] = x;
+	return x;
+}
+
+/* Counts e in the tree (take) or out of it (drop), link-cut trees aside */
+void DynamicTree::take(size_t e) {
+	_role[e] = TREE;
+	_adjacent[_edges.city_a(e)].push_back(e);
+	_adjacent[_edges.city_b(e)].push_back(e);
+
+	_budget.cost += _edges.cost(e);
+	if (_edges.city_a(e) != AIRPORT) {
+		_budget.num_roads++;
+	} else {
+		_budget.num_airports++;
+	}
+}
+
+void DynamicTree::drop(size_t e) {
+	_role[e] = OUT;
+	for ( Vertex city : { _edges.city_a(e), _edges.city_b(e) } ) {
+		vector<size_t> &edges = _adjacent[city];
+		*find(edges.begin(), edges.end(), e) = edges.back();
+		edges.pop_back();
 	}
-} lower_edge;
+
+	_budget.cost -= _edges.cost(e);
+	if (_edges.city_a(e) != AIRPORT) {
+		_budget.num_roads--;
+	} else {
+		_budget.num_airports--;
+	}
+}
+
+void DynamicTree::link(size_t e) {
+	size_t x = new_node(e);
+
+	_links.link(city_node(_edges.city_a(e)), x);
+	_links.link(x, city_node(_edges.city_b(e)));
+	take(e);
+}
+
+void DynamicTree::cut(size_t e) {
+	size_t x = _node[e];
+
+	_links.cut(city_node(_edges.city_a(e)), x);
+	_links.cut(x, city_node(_edges.city_b(e)));
+	_links.set_edge(x, 0, NO_EDGE);
+	_free.push_back(x);
+	_node[e] = 0;
+	drop(e);
+}
+
+void DynamicTree::spare(size_t e) {
+	_role[e] = SPARE;
+	if (e >= _sorted) { _spares.insert(make_pair(_edges.key(e), e)); }
+}
+
+void DynamicTree::unspare(size_t e) {
+	_role[e] = OUT;
+	if (e >= _sorted) { _spares.erase(make_pair(_edges.key(e), e)); }
+}
+
+/* Walks the trees of city_a & city_b a vertex at a time each, until one of
+** them is done. Returns the mark of the one that was. */
+size_t DynamicTree::mark_smaller(Vertex city_a, Vertex city_b) {
+	size_t next[2] = { 0, 0 };
+
+	_stamp += 2;
+	_walk[0].assign(1, city_a);
+	_walk[1].assign(1, city_b);
+	_mark[city_a] = _stamp;
+	_mark[city_b] = _stamp + 1;
+
+	for ( int half = 0; ; half = !half ) {
+		if (next[half] == _walk[half].size()) { return _stamp + half; }
+
+		Vertex u = _walk[half][next[half]++];
+		for ( size_t e : _adjacent[u] ) {
+			Vertex v = other(e, u);
+			if (_mark[v] != _stamp + half) {
+				_mark[v] = _stamp + half;
+				_walk[half].push_back(v);
+			}
+		}
+	}
+}
+
+/* Kruskal over the sorted edges, those not current left out. The trees are
+** then hung on the link-cut trees top-down, a parent pointer at a time. */
+void DynamicTree::build(const vector<bool> &current) {
+	Sets sets(_num_cities + 1);
+	size_t left = _with_airports ? _num_cities : _num_cities - 1;
+
+	for ( size_t e = 0; e < _sorted; e++ ) {
+		if ( !current[e] || (!_with_airports && _edges.city_a(e) == AIRPORT) ) { continue; }
+
+		/* Once the tree spans, the rest are all spares */
+		if (left > 0 && sets.join(_edges.city_a(e), _edges.city_b(e))) {
+			take(e);
+			left--;
+		} else {
+			spare(e);
+		}
+	}
+
+	_stamp = 2;
+	for ( Vertex root = 0; root <= _num_cities; root++ ) {
+		if (_mark[root] == _stamp) { continue; }
+
+		_mark[root] = _stamp;
+		_walk[0].assign(1, root);
+		for ( size_t next = 0; next < _walk[0].size(); next++ ) {
+			Vertex u = _walk[0][next];
+			for ( size_t e : _adjacent[u] ) {
+				Vertex v = other(e, u);
+				if (_mark[v] == _stamp) { continue; }
+
+				size_t x = new_node(e);
+				_links.hang(x, city_node(u));
+				_links.hang(city_node(v), x);
+				_mark[v] = _stamp;
+				_walk[0].push_back(v);
+			}
+		}
+	}
+}
+
+void DynamicTree::insert(size_t e) {
+	if ( !_with_airports && _edges.city_a(e) == AIRPORT ) { return; }
+	if ( e >= _role.size() ) {
+		_role.resize(e + 1, OUT);
+		_node.resize(e + 1, 0);
+	}
+
+	if (joins(e)) {
+		link(e);
+		return;
+	}
+
+	/* e closes a cycle: it's in the tree only if lighter than the rest of it.
+	** A loop closes one with no edges at all, so it never is. */
+	size_t f = _links.edge(_links.heaviest(city_node(_edges.city_a(e)), city_node(_edges.city_b(e))));
+	if (f != NO_EDGE && lighter(e, f)) {
+		cut(f);
+		spare(f);
+		link(e);
+	} else {
+		spare(e);
+	}
+}
+
+#define crosses(f, mark) ((_mark[_edges.city_a(f)] == (mark)) != (_mark[_edges.city_b(f)] == (mark)))
+
+void DynamicTree::erase(size_t e) {
+	if ( e >= _role.size() || _role[e] == OUT ) { return; }
+	if ( _role[e] == SPARE ) {
+		unspare(e);
+		return;
+	}
+
+	uint64_t key = _edges.key(e);
+	size_t from = e + 1, best = NO_EDGE;
+	Vertex city_a = _edges.city_a(e), city_b = _edges.city_b(e);
+
+	cut(e);
+	size_t mark = mark_smaller(city_a, city_b);
+
+	/* Sorted edges after e: past the ones of its key, if it came later */
+	if (e >= _sorted) {
+		size_t to = _sorted;
+		for ( from = 0; from < to; ) {
+			size_t mid = from + (to - from) / 2;
+			if (_edges.key(mid) <= key) { from = mid + 1; } else { to = mid; }
+		}
+	}
+	for ( size_t f = from; f < _sorted; f++ ) {
+		if (_role[f] == SPARE && crosses(f, mark)) {
+			best = f;
+			break;
+		}
+	}
+
+	/* Then the ones that came later, lightest first */
+	for ( set< pair<uint64_t, size_t> >::iterator it = _spares.upper_bound(make_pair(key, e));
+		it != _spares.end() && (best == NO_EDGE || lighter(it->second, best)); ++it ) {
+		if (crosses(it->second, mark)) {
+			best = it->second;
+			break;
+		}
+	}
+
+	if (best != NO_EDGE) {
+		unspare(best);
+		link(best);
+	}
+}
 
 /* Graph Structure */
 class Graph {
@@ -61,72 +1038,64 @@ class Graph {
 		size_t _num_vertices;
 		Budget _budget;
 
-		vector<Edge> _edges;
-		int *_rank;
-		Vertex *_parent;
+		Edges _edges;
+		size_t _run_edges;       /* Edges kept before spilling a run, or 0 */
+		vector<FILE*> _runs;
+		vector<size_t> _levels;  /* Merges that went into each run */
+
+		FILE *new_run();
+		void write_block(FILE *run, vector<Spilled> &block);
+		void spill();
+		bool lighter(size_t e, size_t f) const;
+		void take_budget(const Budget &roads, const Budget &roads_airports);
+		void boruvka_reset(Boruvka *bv, unsigned part, size_t begin, size_t end);
+		void boruvka_offer(Boruvka *bv, unsigned part, size_t begin, size_t end);
+		void boruvka_link(Boruvka *bv, unsigned part, size_t begin, size_t end);
+		void boruvka_run(void (Graph::*pass)(Boruvka*, unsigned, size_t, size_t), Boruvka *bv, size_t size);
+		void boruvka_forest(Boruvka *bv);
 
 	public:
-		Graph(int num_vertices);
+		Graph(size_t num_vertices);
 		~Graph();
 
 		/* Class attribute methods */
 		size_t cost()         const { return _budget.cost; }
 		size_t num_roads()    const { return _budget.num_roads; }
 		size_t num_airports() const { return _budget.num_airports; }
-		void reserve(size_t val)    { _edges.reserve(val); }
+		void reserve(size_t val)    { _edges.reserve(_run_edges > 0 ? min(val, _run_edges) : val); }
+		void external(size_t run_edges) { _run_edges = run_edges; }
 		size_t size()         const { return _num_vertices; }
 		Status status()       const { return _status; }
 
 		/* Class functional methods */
-		void connect(Vertex u, Vertex v, int city_cost) {
-			_edges.push_back(new_edge(u, v, city_cost));
-		}
-		void re_set() {
-			for ( Vertex city = 0; city <= size(); city++ ) {
-				make_set(city);
-			}
-		}
-		void make_set(Vertex u) {
-			_rank[u] = 0;
-			_parent[u] = u;
-		}
-		Vertex find_set(Vertex u) {
-			if (u != _parent[u]) { _parent[u] = find_set(_parent[u]); }
-			return _parent[u];
-		}
-		void merge_set(Vertex u, Vertex v) {
-			if (u == v) { return; }
-
-			if (_rank[u] < _rank[v]) { _parent[u] = v; }
-			else if (_rank[u] > _rank[v]) { _parent[v] = u; }
-			else {
-				_parent[v] = u;
-				_rank[u]++;
-			}
+		void connect(Vertex u, Vertex v, size_t city_cost) {
+			_edges.push(u, v, city_cost);
+			if (_edges.size() == _run_edges) { spill(); }
 		}
 
 		/* Operator overrides */
 		friend ostream& operator<<(ostream& os, const Graph &graph);
 
 		/* Algorithmic methods */
-		void min_span_tree(Budget &roads, vector<bool> &visited);
-		void solve();
+		void kruskal(Forests &forests, size_t from, size_t to);
+		void filter_kruskal(Forests &forests, size_t from, size_t to, unsigned depth);
+		void boruvka(Forests &forests, unsigned threads);
+		void prim_forest(Forests &forests, const Adjacency &adj, bool with_airports, vector<bool> *taken);
+		void prim(Forests &forests);
+		void merge_runs(Forests *forests, size_t from);
+		void solve(Engine engine);
+		void query(Input *in);
 };
 
 /* Builds Graph */
-Graph::Graph(int num_vertices) {
-
-	_rank = new int[num_vertices + 1];
-	_parent = new Vertex[num_vertices + 1];
+Graph::Graph(size_t num_vertices) {
 
 	_status = CORRECT;
 	_num_vertices = num_vertices;
+	_run_edges = 0;
 
 }
-Graph::~Graph() {
-	delete [] _rank;
-	delete [] _parent;
-}
+Graph::~Graph() { /* Nothing here */ }
 
 /* Examines Graph */
 ostream& operator<<(ostream& os, const Graph &graph) {
@@ -141,88 +1110,428 @@ ostream& operator<<(ostream& os, const Graph &graph) {
 	}
 }
 
-/* Generates a Minimum Spanning Tree */
-void Graph::min_span_tree(Budget &budget, vector<bool> &visited) {
-	re_set(); /* Resetting Graph's ranks and parents */
+/* Offers the sorted edges [from, to) to both forests, until they're done.
+** Edges go KRUSKAL_BLOCK at a time, the next block's cities being fetched
+** while this one's are offered, so that their cache misses overlap. */
+void Graph::kruskal(Forests &forests, size_t from, size_t to) {
+	for ( size_t block = from; block < to && !forests.done(); block += KRUSKAL_BLOCK ) {
+		size_t end = min(block + KRUSKAL_BLOCK, to), next = min(end + KRUSKAL_BLOCK, to);
 
-	vector<Edge>::const_iterator it;
-	for ( it = _edges.begin() ; it != _edges.end(); it++ ) {
-		size_t city_cost = (*it).first;
-		Vertex city_a = (*it).second.first;
-		Vertex city_b = (*it).second.second;
+		for ( size_t e = end; e < next; e++ ) { forests.touch(_edges.city_a(e), _edges.city_b(e)); }
+		for ( size_t e = block; e < end && !forests.done(); e++ ) {
+			forests.add(_edges.city_a(e), _edges.city_b(e), _edges.cost(e));
+		}
+	}
+}
 
-		if (visited.empty() && city_a == AIRPORT) { continue; }
+/* Filter-Kruskal on edges [from, to): splits them around a pivot key, grows
+** the forests with the light ones, then drops the heavy ones neither forest
+** wants anymore before going on with them. Only edges that survive the
+** filtering get sorted. The heavy ones go on in a loop, so only light ones
+** recurse, at most depth times. */
+void Graph::filter_kruskal(Forests &forests, size_t from, size_t to, unsigned depth) {
+	while ( !forests.done() && to - from > FILTER_MIN && depth > 0 ) {
+		uint64_t a = _edges.key(from), b = _edges.key(from + (to - from) / 2), c = _edges.key(to - 1);
+		uint64_t pivot = max(min(a, b), min(max(a, b), c));
+		size_t heavy = partition(_edges, from, to, [&](size_t e) { return _edges.key(e) <= pivot; });
 
-		Vertex set_a = find_set(city_a);
-		Vertex set_b = find_set(city_b);
+		/* A pivot that's the heaviest key splits nothing: sort it all instead */
+		if ( heavy == to ) { break; }
 
-		if ( set_a != set_b ) {
+		depth--;
+		filter_kruskal(forests, from, heavy, depth);
+		to = partition(_edges, heavy, to, [&](size_t e) {
+			return forests.wanted(_edges.city_a(e), _edges.city_b(e));
+		});
+		from = heavy;
+	}
+
+	if ( forests.done() ) { return; }
+	_edges.sort(from, to);
+	kruskal(forests, from, to);
+}
 
-			merge_set(set_a, set_b);
+/*
+** Borůvka: each round, every component picks its lightest edge out and links
+** along it. Ties go by input order, so the edges picked form a forest (at
+** most one of them ever links 2 given components) and the trees are the ones
+** a stable sort & Kruskal would give. Each round takes 3 passes, split across
+** threads: reset the picks, offer every alive edge to both its components
+** (dropping those inside one), and link each component along its pick.
+*/
+bool Graph::lighter(size_t e, size_t f) const {
+	return f == NO_EDGE || _edges.key(e) < _edges.key(f) || (_edges.key(e) == _edges.key(f) && e < f);
+}
 
-			budget.cost += city_cost;
+void Graph::boruvka_reset(Boruvka *bv, unsigned, size_t begin, size_t end) {
+	for ( size_t u = begin; u < end; u++ ) { bv->best[u].store(NO_EDGE, memory_order_relaxed); }
+}
 
-			if (!visited.empty()) {
-				visited[city_b] = true;
-				if (city_a != AIRPORT) {
-					budget.num_roads++;
-				} else {
-					budget.num_airports++;
-				}
-			} else {
-				budget.num_roads++;
-			}
+void Graph::boruvka_offer(Boruvka *bv, unsigned part, size_t begin, size_t end) {
+	for ( size_t i = begin; i < end; i++ ) {
+		size_t e = bv->alive[i];
+		Vertex set_a = bv->find_set(_edges.city_a(e));
+		Vertex set_b = bv->find_set(_edges.city_b(e));
 
+		if (set_a == set_b) { continue; }
+		bv->kept[part].push_back(e);
+		for ( Vertex set : { set_a, set_b } ) {
+			size_t seen = bv->best[set].load(memory_order_relaxed);
+			while (lighter(e, seen) && !bv->best[set].compare_exchange_weak(seen, e, memory_order_relaxed));
 		}
 	}
 }
 
-void Graph::solve(void) {
+void Graph::boruvka_link(Boruvka *bv, unsigned part, size_t begin, size_t end) {
+	for ( size_t u = begin; u < end; u++ ) {
+		size_t e = bv->best[u].load(memory_order_relaxed);
 
-	/* Shared variables */
-	vector<bool> visited;
-	Budget roads = { 0, 0, 0 }, roads_airports = { 0, 0, 0 };
+		/* Both ends may pick the same edge: only one links it */
+		if (e != NO_EDGE && bv->join(_edges.city_a(e), _edges.city_b(e))) {
+			bv->taken[part].push_back(e);
+		}
+	}
+}
 
-	/* Sorting our vector ONCE */
-	sort(_edges.begin(), _edges.end(), lower_edge);
+/* Runs pass over size items, split across threads if there are enough */
+void Graph::boruvka_run(void (Graph::*pass)(Boruvka*, unsigned, size_t, size_t), Boruvka *bv, size_t size) {
+	unsigned threads = size < BORUVKA_PARALLEL_MIN ? 1 : bv->threads;
+	vector<thread> pool;
 
-	/* MST has no airports */
-	min_span_tree(roads, visited);
+	for (unsigned t = 1; t < threads; t++) {
+		pool.push_back(thread(pass, this, bv, t, size * t / threads, size * (t+1) / threads));
+	}
+	(this->*pass)(bv, 0, 0, size / threads);
+	for (size_t t = 0; t < pool.size(); t++) { pool[t].join(); }
+}
+
+/* Grows a spanning forest out of the alive edges, into taken */
+void Graph::boruvka_forest(Boruvka *bv) {
+	size_t taken = 0, before;
+
+	bv->make_sets();
+	do {
+		before = taken;
+		boruvka_run(&Graph::boruvka_reset, bv, bv->best.size());
+
+		for (unsigned t = 0; t < bv->threads; t++) { bv->kept[t].clear(); }
+		boruvka_run(&Graph::boruvka_offer, bv, bv->alive.size());
+		bv->alive.clear();
+		for (unsigned t = 0; t < bv->threads; t++) {
+			bv->alive.insert(bv->alive.end(), bv->kept[t].begin(), bv->kept[t].end());
+		}
+
+		boruvka_run(&Graph::boruvka_link, bv, bv->best.size());
+		taken = 0;
+		for (unsigned t = 0; t < bv->threads; t++) { taken += bv->taken[t].size(); }
+	} while (taken > before);
+}
+
+/* Both MSTs with Borůvka. Roads off the one without airports are the heaviest
+** in some cycle of roads, so the one with airports is grown out of just its
+** roads and every airport */
+void Graph::boruvka(Forests &forests, unsigned threads) {
+	Boruvka bv(size() + 1, threads);
+
+	for ( size_t e = 0; e < _edges.size(); e++ ) {
+		if (_edges.city_a(e) != AIRPORT) { bv.alive.push_back(e); }
+	}
+	boruvka_forest(&bv);
+
+	bv.alive.clear();
+	for ( size_t e = 0; e < _edges.size(); e++ ) {
+		if (_edges.city_a(e) == AIRPORT) { bv.alive.push_back(e); }
+	}
+	for (unsigned t = 0; t < threads; t++) {
+		for ( size_t e : bv.taken[t] ) {
+			forests.take(_edges.city_a(e), _edges.cost(e), false);
+			bv.alive.push_back(e);
+		}
+		bv.taken[t].clear();
+	}
+	boruvka_forest(&bv);
+
+	for (unsigned t = 0; t < threads; t++) {
+		for ( size_t e : bv.taken[t] ) {
+			forests.take(_edges.city_a(e), _edges.cost(e), true);
+		}
+	}
+}
+
+/* Grows a spanning forest over adj with Prim, from every city not reached yet
+** (the sky first, with airports), into one of the forests. Ties go by input
+** order, so the trees are the ones a stable sort & Kruskal would give. */
+void Graph::prim_forest(Forests &forests, const Adjacency &adj, bool with_airports, vector<bool> *taken) {
+	Heap heap(size() + 1);
+
+	for ( Vertex root = with_airports ? AIRPORT : 1; root <= size(); root++ ) {
+		if (heap.reached(root)) { continue; }
+
+		heap.offer(root, 0, NO_EDGE);
+		while ( !heap.empty() ) {
+			Vertex city;
+			size_t e = heap.pop(city);
+
+			if (e != NO_EDGE) {
+				forests.take(_edges.city_a(e), _edges.cost(e), with_airports);
+				if (taken != NULL) { (*taken)[e] = true; }
+			}
+			for ( size_t slot = adj.first(city); slot < adj.last(city); slot++ ) {
+				const Arc &arc = adj.arc(slot);
+				if (!heap.reached(arc.city)) { heap.offer(arc.city, arc.key, arc.edge); }
+			}
+		}
+	}
+}
+
+/* Both MSTs with Prim. Like Borůvka's, the one with airports is grown out of
+** just the roads of the one without and every airport. */
+void Graph::prim(Forests &forests) {
+	vector<bool> taken(_edges.size(), false);
+
+	{
+		Adjacency roads(_edges, size(), [&](size_t e) { return _edges.city_a(e) != AIRPORT; });
+		prim_forest(forests, roads, false, &taken);
+	}
+	Adjacency all(_edges, size(), [&](size_t e) { return _edges.city_a(e) == AIRPORT || taken[e]; });
+	prim_forest(forests, all, true, NULL);
+}
+
+FILE *Graph::new_run() {
+	FILE *run = tmpfile();
+
+	if (run == NULL) {
+		perror("Can't spill a run");
+		exit(EXIT_FAILURE);
+	}
+	return run;
+}
+
+void Graph::write_block(FILE *run, vector<Spilled> &block) {
+	if (fwrite(block.data(), sizeof(Spilled), block.size(), run) != block.size()) {
+		perror("Can't spill a run");
+		exit(EXIT_FAILURE);
+	}
+	block.clear();
+}
 
-	/* MST has airports */
-	visited = vector<bool>(size() + 1, false);
-	min_span_tree(roads_airports, visited);
+/* Sorts the edges in memory & spills them to a new run */
+void Graph::spill() {
+	FILE *run = new_run();
+	vector<Spilled> block;
+
+	_edges.sort(0, _edges.size());
+	block.reserve(MERGE_BLOCK);
+	for ( size_t e = 0; e < _edges.size(); e++ ) {
+		Spilled edge = { _edges.key(e), _edges.city_a(e), _edges.city_b(e) };
+
+		block.push_back(edge);
+		if (block.size() == MERGE_BLOCK) { write_block(run, block); }
+	}
+	write_block(run, block);
+
+	rewind(run);
+	_runs.push_back(run);
+	_levels.push_back(0);
+	_edges.clear();
+
+	while (_runs.size() >= MERGE_WAYS && _levels[_runs.size() - MERGE_WAYS] == _levels.back()) {
+		merge_runs(NULL, _runs.size() - MERGE_WAYS);
+	}
+}
+
+/* Merges the runs from the given one on in sorted order, ties going to the
+** earlier run as a stable sort of all the edges would: into both forests, until
+** they're done, or (with no forests) into a single run that takes their place */
+void Graph::merge_runs(Forests *forests, size_t from) {
+	typedef pair<uint64_t, size_t> Head;   /* (key, run) */
+	priority_queue< Head, vector<Head>, greater<Head> > heads;
+	vector<Run> runs(_runs.size() - from);
+	size_t level = _levels[from] + 1;
+	FILE *merged = forests == NULL ? new_run() : NULL;
+	vector<Spilled> block;
+
+	for ( size_t r = 0; r < runs.size(); r++ ) {
+		runs[r].file = _runs[from + r];
+		if (runs[r].refill()) { heads.push(make_pair(runs[r].block[0].key, r)); }
+	}
+
+	while ( !heads.empty() && (forests == NULL || !forests->done()) ) {
+		size_t r = heads.top().second;
+		Run &run = runs[r];
+		Spilled edge = run.block[run.next++];
+
+		heads.pop();
+		if (run.next < run.block.size() || run.refill()) { heads.push(make_pair(run.block[run.next].key, r)); }
+
+		if (forests != NULL) {
+			forests->add(edge.city_a, edge.city_b, edge.key >> 1);
+		} else {
+			block.push_back(edge);
+			if (block.size() == MERGE_BLOCK) { write_block(merged, block); }
+		}
+	}
+
+	for ( size_t r = from; r < _runs.size(); r++ ) { fclose(_runs[r]); }
+	_runs.resize(from);
+	_levels.resize(from);
+
+	if (merged != NULL) {
+		write_block(merged, block);
+		rewind(merged);
+		_runs.push_back(merged);
+		_levels.push_back(level);
+	}
+}
+
+void Graph::solve(Engine engine) {
+
+	/* Shared variables */
+	Forests forests(size());
+
+	/* MSTs without airports & with them */
+	if (engine == AUTO) {
+		engine = _edges.size() >= DENSE_EDGES * size() ? FILTER_KRUSKAL : KRUSKAL;
+	}
+	if (engine == PRIM) {
+		prim(forests);
+	} else if (engine == FILTER_KRUSKAL) {
+		unsigned depth = 0;
+		for ( size_t n = _edges.size(); n > 1; n /= 2 ) { depth += 2; }
+		filter_kruskal(forests, 0, _edges.size(), depth);
+	} else if (engine == EXTERNAL) {
+		spill();
+		merge_runs(&forests, 0);
+	} else if (engine == BORUVKA) {
+		boruvka(forests, Threads_Count());
+	} else {
+		_edges.sort(0, _edges.size());
+		kruskal(forests, 0, _edges.size());
+	}
 
 	/* Taking road costs */
+	take_budget(forests.roads(), forests.roads_airports());
+}
+
+/* Takes the cheapest MST that spans every city: without airports or with them.
+** If neither does, some city is cut off. */
+void Graph::take_budget(const Budget &roads, const Budget &roads_airports) {
+	_status = CORRECT;
 	if (roads.num_roads == size()-1) {
 		_budget = (roads.cost <= roads_airports.cost) ? roads : roads_airports;
 	} else {
 		_budget = roads_airports;
+		if (roads_airports.num_roads + roads_airports.num_airports < size()) { _status = INSUFFICIENT; }
+	}
+}
 
-		for (Vertex city = 1; city <= size(); city++) {
-			if (!visited[city]) {
-				_status = INSUFFICIENT;
-				break;
-			}
+/*
+** What-if queries, read from in after solving: "city_a city_b cost" builds the
+** road between them (or, with city_a 0, an airport at city_b) at that cost, in
+** place of any there was; a cost of -1 closes it. Both MSTs are kept up to
+** date as DynamicTrees, without sorting again, and the answer is printed after
+** each query. Cities are cut off if neither tree spans them all.
+** A query is polylog unless it closes or re-prices a tree edge, which can
+** take O(E) (see DynamicTree).
+*/
+#define ends(a, b) ((uint64_t) min(a, b) << 32 | (uint64_t) max(a, b))
+
+void Graph::query(Input *in) {
+	vector< pair<uint64_t, size_t> > by_ends(_edges.size());  /* Sorted (ends, Edge) */
+	unordered_map<uint64_t, size_t> changed;   /* changed[ends] = Edge, or NO_EDGE */
+	vector<bool> is_current(_edges.size());
+	long city_a, city_b, city_cost;
+
+	/* Parallel edges stay in sorted order: only the lightest is kept, as a query
+	** replaces them all */
+	_edges.sort(0, _edges.size());
+	for ( size_t e = 0; e < _edges.size(); e++ ) { by_ends[e] = make_pair(ends(_edges.city_a(e), _edges.city_b(e)), e); }
+	radix_sort(by_ends.data(), by_ends.size(), [](const pair<uint64_t, size_t> &item) { return item.first; });
+	for ( size_t i = 0; i < by_ends.size(); i++ ) {
+		is_current[by_ends[i].second] = i == 0 || by_ends[i - 1].first != by_ends[i].first;
+	}
+
+	DynamicTree roads(_edges, size(), false), roads_airports(_edges, size(), true);
+	roads.build(is_current);
+	roads_airports.build(is_current);
+
+	while ( Input_Long(in, &city_a) && Input_Long(in, &city_b) && Input_Long(in, &city_cost) ) {
+		if (city_a < 0 || city_b < 1 || (size_t) max(city_a, city_b) > size()) {
+			cerr << "No such cities: " << city_a << " " << city_b << endl;
+			continue;
+		}
+		if (city_a == city_b) {
+			cerr << "A road must join two cities: " << city_a << " " << city_b << endl;
+			continue;
+		}
+
+		uint64_t key = ends(city_a, city_b);
+		size_t e = NO_EDGE;
+		if (changed.count(key)) {
+			e = changed[key];
+		} else {
+			vector< pair<uint64_t, size_t> >::iterator it =
+				lower_bound(by_ends.begin(), by_ends.end(), make_pair(key, (size_t) 0));
+			if (it != by_ends.end() && it->first == key) { e = it->second; }
+		}
+
+		if (e != NO_EDGE) {
+			roads.erase(e);
+			roads_airports.erase(e);
+		}
+		changed[key] = NO_EDGE;
+		if (city_cost >= 0) {
+			_edges.push(city_a, city_b, city_cost);
+			changed[key] = _edges.size() - 1;
+			roads.insert(_edges.size() - 1);
+			roads_airports.insert(_edges.size() - 1);
 		}
+
+		/* Taking road costs, as solve() does */
+		take_budget(roads.budget(), roads_airports.budget());
+		cout << *this << endl;
 	}
 }
 
 /***************************** MAIN function **********************************/
-int main(void) {
-	size_t num_cities, num_airports, num_roads;
+/* Usage: projpp [--kruskal | --prim | --filter | --boruvka | --external [run_edges]]
+**               [--query file] < input
+** Without an engine, Filter-Kruskal or Kruskal is picked by how dense the graph is.
+** --query answers each query in polylog time, but O(E) when a tree edge goes. */
+int main(int argc, char *argv[]) {
+	size_t num_cities, num_airports, num_roads, run_edges = RUN_EDGES;
+	Engine engine = AUTO;
+	const char *queries = NULL;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--kruskal") == 0) { engine = KRUSKAL; }
+		if (strcmp(argv[i], "--prim") == 0) { engine = PRIM; }
+		if (strcmp(argv[i], "--filter") == 0) { engine = FILTER_KRUSKAL; }
+		if (strcmp(argv[i], "--boruvka") == 0) { engine = BORUVKA; }
+		if (strcmp(argv[i], "--external") == 0) {
+			engine = EXTERNAL;
+			if (i + 1 < argc && atol(argv[i + 1]) > 0) { run_edges = atol(argv[++i]); }
+		}
+		if (strcmp(argv[i], "--query") == 0 && i + 1 < argc) { queries = argv[++i]; }
+	}
+	if (engine == EXTERNAL && queries != NULL) {
+		cerr << "Queries need every edge in memory: no --external with --query" << endl;
+		return EXIT_FAILURE;
+	}
 
 	/* Get number of Cities */
+	Bench_Phase(BENCH_PARSE);
 	get_numbers(num_cities);
-	Graph g(num_cities);
+	Graph g(new_vertex(num_cities));
+	if (engine == EXTERNAL) { g.external(run_edges); }
 
 	/* Get Cost of each Airport (city, cost) */
 	get_numbers(num_airports);
 	g.reserve(num_airports);
-	while ( num_airports-- > 0 ) {
+	for ( size_t i = 0; i < num_airports; i++ ) {
 		size_t city, cost;
 		get_numbers(city, cost);
-		g.connect(AIRPORT, city, cost);
+		g.connect(AIRPORT, new_vertex(city), cost);
 	}
 
 	/* Get Cost of each Road (city_a, city_b, cost) */
@@ -231,13 +1540,28 @@ int main(void) {
 	while ( num_roads-- > 0 ) {
 		size_t city_a, city_b, cost;
 		get_numbers(city_a, city_b, cost);
-		g.connect(city_a, city_b, cost);
+		g.connect(new_vertex(city_a), new_vertex(city_b), cost);
 	}
 
 	/* Solve the graph */
-	g.solve();
+	Bench_Phase(BENCH_SOLVE);
+	g.solve(engine);
 
+	Bench_Phase(BENCH_OUTPUT);
 	cout << g << endl;
 
+	if (queries != NULL) {
+		Input in;
+		int fd = open(queries, O_RDONLY);
+
+		if (fd < 0 || !Input_Open(&in, fd)) {
+			cerr << "Can't read " << queries << endl;
+			return EXIT_FAILURE;
+		}
+		g.query(&in);
+		Input_Close(&in);
+		close(fd);
+	}
+
 	return 0;
 }
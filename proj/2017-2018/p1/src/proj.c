@@ -7,9 +7,14 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+/* Shared libraries */
+#include "CSR.h"
+#include "Output.h"
+#include "Bench.h"
+
 /*************************** Auxiliary functions ******************************/
-#define get_number(a)     scanf("%d", a)
-#define get_numbers(a, b) scanf("%d %d", a, b)
+#define get_number(a)     GraphFile_Read(GF_COUNTS, a)
+#define get_edge(a, b)    GraphFile_ReadEdge(a, b)
 #define max(a, b) (a < b ? b : a)
 #define min(a, b) (a > b ? b : a)
 
@@ -27,11 +32,6 @@ typedef int Vertex;
 #define vertex_root(a) 1
 #define vertex_end(GRAPH, a)  a <= GRAPH->nr_vertices
 
-int cmp_vertex(const void *a, const void *b)
-{
-	return ( *(const Vertex*)a - *(const Vertex*)b );
-}
-
 /* Edge Structure */
 typedef int Edge;
 
@@ -71,6 +71,12 @@ void stack_destroy(Stack *st)
 	free(st->in_stack); st->in_stack = NULL;
 }
 
+/* A DFS call Tarjan's algorithm has yet to return from */
+typedef struct frame {
+	Vertex u;
+	Edge next;   /* Next Edge of u's to follow */
+} Frame;
+
 /* Graph Structure */
 typedef struct graph {
 
@@ -78,31 +84,15 @@ typedef struct graph {
 	int nr_vertices;
 	int nr_edges;
 
-	/* Graph composition, represented as an Edge array */
-	Edge   *first;    /* first[Vertex] = Edge   */
-	Vertex *vertex;   /* vertex[Edge]  = Vertex */
-	Edge   *next;     /* next[Edge]    = Edge   */
+	/* Graph composition: connections are collected, then laid out as a CSR */
+	CSR links;
 
 } Graph;
 
-/* Connects two Vertices */
+/* Connects two Vertices (repeats are dropped by graph_sort) */
 void graph_connect(Graph *g, Vertex u, Vertex v)
 {
-	g->nr_edges++;
-	g->vertex[g->nr_edges] = v;
-
-	if (g->first[u] == 0) {
-		g->first[u] = g->nr_edges;
-	} else {
-		Edge adj;
-		for (adj = g->first[u]; g->next[adj] != 0 && g->vertex[adj] != v; adj = g->next[adj]);
-		/* if Vertex v is already in here, stop everything */
-		if (g->vertex[adj] == v) {
-			g->vertex[g->nr_edges--] = 0;
-			return;
-		}
-		g->next[adj] = g->nr_edges;
-	}
+	CSR_Add(&g->links, u, v, 0);
 }
 
 /* Creates a new Graph */
@@ -111,149 +101,157 @@ void graph_new(Graph *g, int num_v, int num_e)
 	g->nr_vertices = num_v;
 	g->nr_edges    = 0;
 
-	g->first  = calloc((num_v+1), sizeof(g->first));
-	g->vertex = calloc((num_e+1), sizeof(g->vertex));
-	g->next   = calloc((num_e+1), sizeof(g->next));
+	CSR_New(&g->links, num_v, num_e, false);
 }
 
-/* Initializes Graph with input data */
-void graph_init(Graph *g, int num_e)
+/* Initializes the input graph with input data */
+void graph_init(CSR *g, int num_e)
 {
+	/* Binary graph files already come laid out */
+	if (GraphFile_Stdin() && CSR_FromFile(g, GraphFile_Stdin(), true)) {
+		return;
+	}
+
 	while (num_e-- > 0) {
 		int num1, num2;
 		Vertex u, v;
 
 		/* Grab two numbers from input & convert them to Vertex */
-		get_numbers(&num1, &num2);
+		get_edge(&num1, &num2);
 		u = vertex_new(num1);
 		v = vertex_new(num2);
 		/* Connect them to the graph */
-		graph_connect(g, u, v);
+		CSR_Add(g, u, v, 0);
 	}
+
+	/* Repeated Edges are dropped, as graph_connect does */
+	Bench_Phase(BENCH_BUILD);
+	CSR_Build(g, true);
 }
 
 void graph_destroy(Graph *g)
 {
-	free(g->first);    g->first    = NULL;
-	free(g->vertex);   g->vertex   = NULL;
-	free(g->next);     g->next     = NULL;
+	CSR_Destroy(&g->links);
 }
 
+/* Lays the connections out sorted, dropping repeated ones, both in O(V+E) */
 void graph_sort(Graph *g)
 {
-	int idx = 0;
-	Vertex u;
-	Vertex *temp = calloc(g->nr_vertices, sizeof(*temp));
-
-	for (u = vertex_root(); idx < g->nr_edges; u = vertex_next(u)) {
-		size_t count = 0;
-		Edge adj;
-
-		/* Retrieving adjacency list */
-		for (adj = g->first[u]; adj != 0; adj = g->next[adj]) {
-			temp[count++] = g->vertex[adj];
-		}
-
-		/* Sorting */
-		qsort(temp, count, sizeof(Vertex), cmp_vertex);
-
-		/* Putting adjacency list back */
-		count = 0;
-		for (adj = g->first[u]; adj != 0; adj = g->next[adj]) {
-			g->vertex[adj] = temp[count++];
-		}
-		idx += count;
-	}
-
-	free(temp);
+	CSR_SortTargets(&g->links);
+	CSR_Build(&g->links, true);
+	g->nr_edges = g->links.nr_edges;
 }
 
 void graph_print(Graph *g)
 {
-	int idx = 0;
 	Vertex u;
-	printf("%d\n%d\n", g->nr_vertices, g->nr_edges);
+	Output *out = Output_Stdout();
+
+	Output_Int(out, g->nr_vertices); Output_Char(out, '\n');
+	Output_Int(out, g->nr_edges);    Output_Char(out, '\n');
 
-	for (u = vertex_root(); idx < g->nr_edges; u = vertex_next(u)) {
+	for (u = vertex_root(); u <= g->links.nr_vertices; u = vertex_next(u)) {
 		Edge adj;
-		for (adj = g->first[u]; adj != 0; adj = g->next[adj]) {
-			Vertex v = g->vertex[adj];
-			printf("%d %d\n", u, v);
-			idx++;
+		for (adj = g->links.offset[u]; adj < g->links.offset[u+1]; adj++) {
+			Vertex v = g->links.target[adj];
+			Output_Int(out, u); Output_Char(out, ' ');
+			Output_Int(out, v); Output_Char(out, '\n');
 		}
 	}
 }
 
 /****************** Finding Strongly Connected Components *********************/
-/* Apply Tarjan's algorithm to find SCCs */
+/* Apply Tarjan's algorithm to find SCCs, from root. The DFS keeps its calls in
+** frames (a vertex is in one at most), not on the process' stack, so that long
+** paths can't overflow it. */
 void graph_SCC_find_aux(
-	Graph *g, Graph *scc,
+	CSR *g, Graph *scc,
 	Vertex *head,
 	Stack *st, Stack *st_temp,
-	Vertex u,
-	int *disc, int *low, int *disc_time
+	Vertex root,
+	int *disc, int *low, int *disc_time,
+	Frame *frames
 ) {
-	Edge adj;
-	disc[u] = low[u] = ++(*disc_time);
-	stack_push(st, u);
-
-	for (adj = g->first[u]; adj != 0; adj = g->next[adj]) {
-		Vertex v = g->vertex[adj];
-
-		/* If v is not visited yet, recur for it */
-		if (disc[v] == 0) {
-			graph_SCC_find_aux(g, scc, head, st, st_temp, v, disc, low, disc_time);
-			low[u] = min(low[u], low[v]);
-		}
-		/* Update low value of 'u' only if 'v' is still in stack */
-		else if (stack_contains(st, v)) {
-			low[u] = min(low[u], disc[v]);
+	int depth = 0;
+
+	disc[root] = low[root] = ++(*disc_time);
+	stack_push(st, root);
+	frames[0].u = root;
+	frames[0].next = g->offset[root];
+
+	for (;;) {
+		Vertex u = frames[depth].u;
+
+		if (frames[depth].next < g->offset[u+1]) {
+			Vertex v = g->target[frames[depth].next++];
+
+			/* If v is not visited yet, recur for it */
+			if (disc[v] == 0) {
+				disc[v] = low[v] = ++(*disc_time);
+				stack_push(st, v);
+				depth++;
+				frames[depth].u = v;
+				frames[depth].next = g->offset[v];
+			}
+			/* Update low value of 'u' only if 'v' is still in stack */
+			else if (stack_contains(st, v)) {
+				low[u] = min(low[u], disc[v]);
+			}
+			continue;
 		}
-	}
 
-	/* head node found; so it's an SCC. Popping stack until we reach head node. */
-	if (low[u] == disc[u]) {
-		Vertex v, root = u;
-		scc->nr_vertices++;
+		/* head node found; so it's an SCC. Popping stack until we reach head node. */
+		if (low[u] == disc[u]) {
+			Vertex v, min_v = u;
+			scc->nr_vertices++;
 
-		stack_push(st_temp, u);
-		while ((v = stack_pop(st)) != u) {
-			root = min(root, v);
-			stack_push(st_temp, v);
+			stack_push(st_temp, u);
+			while ((v = stack_pop(st)) != u) {
+				min_v = min(min_v, v);
+				stack_push(st_temp, v);
+			}
+			head[u] = min_v;
+			while ((v = stack_pop(st_temp)) != u) {
+				head[v] = min_v;
+			}
 		}
-		head[u] = root;
-		while ((v = stack_pop(st_temp)) != u) {
-			head[v] = root;
+
+		/* Returning to u's caller */
+		if (depth == 0) {
+			return;
 		}
+		depth--;
+		low[frames[depth].u] = min(low[frames[depth].u], low[u]);
 	}
 }
 
-void graph_SCC_find(Graph *g, Graph *scc)
+void graph_SCC_find(CSR *g, Graph *scc)
 {
 	int *disc = calloc(g->nr_vertices+1, sizeof(*disc));
 	int *low  = calloc(g->nr_vertices+1, sizeof(*low));
 	Vertex *head = calloc(g->nr_vertices+1, sizeof(*head));
+	Frame *frames = malloc((g->nr_vertices+1) * sizeof(*frames));
 	int disc_time = 0;
 	Vertex u;
 	Stack st, st_temp;
 
-	/* Initializing data */
-	stack_new(&st, g->nr_vertices);
-	stack_new(&st_temp, g->nr_vertices);
+	/* Initializing data (ids go up to nr_vertices, so that's one more slot) */
+	stack_new(&st, g->nr_vertices+1);
+	stack_new(&st_temp, g->nr_vertices+1);
 	scc->nr_vertices = 0;
 
 	/* Performing first DFS with Tarjan */
 	for (u = vertex_root(); vertex_end(g, u); u = vertex_next(u)) {
         if (disc[u] == 0) {
-            graph_SCC_find_aux(g, scc, head, &st, &st_temp, u, disc, low, &disc_time);
+            graph_SCC_find_aux(g, scc, head, &st, &st_temp, u, disc, low, &disc_time, frames);
 		}
 	}
 
 	/* Scouring through Graph for SCC connections */
 	for (u = vertex_root(); vertex_end(g, u); u = vertex_next(u)) {
 		Edge adj;
-		for (adj = g->first[u]; adj != 0; adj = g->next[adj]) {
-			Vertex v = g->vertex[adj];
+		for (adj = g->offset[u]; adj < g->offset[u+1]; adj++) {
+			Vertex v = g->target[adj];
 
 			/* Found connection between SCCs */
 			if (head[u] != head[v]) {
@@ -268,31 +266,36 @@ void graph_SCC_find(Graph *g, Graph *scc)
 	free(disc);
 	free(low);
 	free(head);
+	free(frames);
 }
 
 /***************************** MAIN function **********************************/
 int main(void) {
 	int num_v, num_e;
-	Graph g, scc;
+	CSR g;
+	Graph scc;
 
 	/* Grabbing input */
+	Bench_Phase(BENCH_PARSE);
 	get_number(&num_v); /* Grabbing number of vertices */
 	get_number(&num_e); /* Grabbing number of edges */
 
 	/* Instancing graphs */
-	graph_new(&g, num_v, num_e);
+	CSR_New(&g, num_v, num_e, false);
 	graph_new(&scc, num_v, num_e);
 
 	graph_init(&g, num_e); /* Initializing Graph from input */
 
 	/* Apply this project's magic */
+	Bench_Phase(BENCH_SOLVE);
 	graph_SCC_find(&g, &scc);
 	graph_sort(&scc);
+	Bench_Phase(BENCH_OUTPUT);
 	graph_print(&scc);
 
 	/* Freeing data */
 	graph_destroy(&scc);
-	graph_destroy(&g);
+	CSR_Destroy(&g);
 
 	return 0;
 }
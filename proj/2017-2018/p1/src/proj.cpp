@@ -3,15 +3,13 @@
 ** Marta Simões     - 81947
 *******************************************************************************/
 
-/* C++ Libraries. Only the bare minimum, no need for clutter */
-#include <iostream>
-#include <list>
-#include <stack>
-#include <algorithm>
+/* Shared libraries */
+#include "ParallelInput.h"
+#include "Output.h"
+#include "Bench.h"
 
 /*************************** Auxiliary functions ******************************/
-#define get_number(a)     std::cin >> a
-#define get_numbers(a, b) std::cin >> a >> b
+void get_number(size_t &a) { int num; GraphFile_Read(GF_COUNTS, &num); a = num; }
 #define max(a, b) (a < b ? b : a)
 #define min(a, b) (a > b ? b : a)
 
@@ -26,203 +24,217 @@ typedef size_t Vertex;
 
 class Stack {
 	private:
-		std::stack<Vertex> _stack;
+		Vertex *_data;   /* _data[idx] = Vertex, bottom first */
+		size_t _size;
 		bool *_in_stack;
 
 	public:
-		Stack(size_t size) { _in_stack = new bool[size]; };
-		~Stack() { delete [] _in_stack; };
+		Stack(size_t size) { _data = new Vertex[size]; _size = 0; _in_stack = new bool[size](); };
+		~Stack() { delete [] _data; delete [] _in_stack; };
 		bool contains(Vertex u) { return _in_stack[u]; }
+		size_t size() const { return _size; }
+		Vertex at(size_t idx) const { return _data[idx]; }
 		void push(const Vertex& u) {
-			_stack.push(u);
+			_data[_size++] = u;
 			_in_stack[u] = true;
 		};
 		Vertex pop() {
-			Vertex u = _stack.top();
-			_stack.pop();
+			Vertex u = _data[--_size];
 			_in_stack[u] = false;
 			return u;
 		};
 };
 
+/* A DFS call Tarjan's algorithm has yet to return from */
+struct Frame {
+	Vertex u;
+	int next;   /* Next Edge of u's to follow */
+};
+
 class Graph {
 	private:
 		size_t nr_vertices, nr_edges;
 		bool *in_graph;
 
-		void SCC_find_aux(Vertex *head, Stack &s, Vertex u, int *disc, int *low, int &disc_time);
+		void SCC_find_aux(Vertex *head, Stack &s, Vertex u, int *disc, int *low, int &disc_time, Frame *frames);
 
 	public:
 		/* Members */
-		std::list<Vertex> *adj; /* Adjacency list of Vertices */
+		CSR csr;                /* Edges, laid out contiguously by init() (or SCC_find) */
 
 		/* Important */
 		Graph(size_t num_v); /* Constructor */
 		void init(size_t num_e);
 		~Graph(); /* Destructor */
 
-		/* Overloaders */
-		friend std::ostream &operator<<(std::ostream &output, const Graph &g);
-
 		/* Methods */
-		void sort();
-		bool has_connection(Vertex u, Vertex v);
-		void connect(Vertex u, Vertex v);
+		void print(Output *out) const;
 		void SCC_find(Graph *scc);
 };
 
 Graph::Graph(size_t num_v)
 {
 	this->nr_vertices = this->nr_edges = 0;
-	this->in_graph = new bool[num_v+1];
-	this->adj = new std::list<Vertex>[num_v+1];
+	this->in_graph = new bool[num_v+1]();
+	CSR_New(&this->csr, num_v, 0, false);
 }
 void Graph::init(size_t num_e)
 {
-	while (num_e-- > 0) {
-		int num1, num2;
-		Vertex u, v;
-
-		/* Grab two numbers from input and convert them to vertices */
-		get_numbers(num1, num2);
-		u = vertex_new(num1); v = vertex_new(num2);
+	/* Binary graph files already come laid out */
+	if (GraphFile_Stdin() && CSR_FromFile(&this->csr, GraphFile_Stdin(), true)) {
+		return;
+	}
 
-		/* Connect them and add them to the graph */
-		this->connect(u, v);
+	if (GraphFile_Stdin()) {
+		while (num_e-- > 0) {
+			int u, v;
+			GraphFile_ReadEdge(&u, &v);
+			CSR_Add(&this->csr, vertex_new(u), vertex_new(v), 0);
+		}
+	} else {
+		/* Text edges are parsed on every core */
+		Input_ParallelEdges(Input_Stdin(), num_e, &this->csr);
 	}
+	/* Repeated connections are dropped here */
+	Bench_Phase(BENCH_BUILD);
+	CSR_Build(&this->csr, true);
 }
 Graph::~Graph()
 {
 	delete [] this->in_graph;
-	delete [] this->adj;
+	CSR_Destroy(&this->csr);
 }
 
-std::ostream &operator<<(std::ostream &output, const Graph &g)
+void Graph::print(Output *out) const
 {
 	/* Printing number of vertices and edges */
-	output << g.nr_vertices << std::endl << g.nr_edges << std::endl;
-
-	/* Printing connections */
-	size_t idx = 0;
-	for (Vertex u = vertex_root(); idx < g.nr_edges; u = vertex_next(u)) {
-		std::list<Vertex>::iterator it;
-		for (it = g.adj[u].begin(); it != g.adj[u].end(); ++it) {
-			Vertex v = *it;
-			output << u << " " << v << std::endl;
-			idx++;
+	Output_Long(out, this->nr_vertices); Output_Char(out, '\n');
+	Output_Long(out, this->nr_edges);    Output_Char(out, '\n');
+
+	/* Printing connections, already sorted */
+	for (Vertex u = vertex_root(); u <= (Vertex) this->csr.nr_vertices; u = vertex_next(u)) {
+		for (int e = csr.offset[u]; e < csr.offset[u+1]; e++) {
+			Output_Long(out, u); Output_Char(out, ' ');
+			Output_Long(out, csr.target[e]); Output_Char(out, '\n');
 		}
 	}
-	return output;
-}
-
-bool Graph::has_connection(Vertex u, Vertex v)
-{
-	/* Search for an already established u-v connection */
-	std::list<Vertex>::iterator it = std::find(this->adj[u].begin(), this->adj[u].end(), v);
-	return it != this->adj[u].end();
-}
-
-void Graph::connect(Vertex u, Vertex v)
-{
-	/* See if our Vertex is in our Graph */
-	if (!this->in_graph[u]) {
-		this->nr_vertices++;
-		this->in_graph[u] = true;
-	}
-	if (!this->in_graph[v]) {
-		this->nr_vertices++;
-		this->in_graph[v] = true;
-	}
-	/* Search for an already established u-v connection */
-	if (!this->has_connection(u, v)) {
-		this->adj[u].push_back(v);
-		this->nr_edges++;
-	}
-}
-
-void Graph::sort()
-{
-	size_t idx = 0;
-	for (Vertex u = vertex_root(); idx < this->nr_edges; u = vertex_next(u)) {
-		this->adj[u].sort();
-		idx+=this->adj[u].size();
-	}
 }
 
 /****************** Finding Strongly Connected Components *********************/
-/* Apply Tarjan's algorithm to find SCCs */
-void Graph::SCC_find_aux(Vertex *head, Stack &st, Vertex u, int *disc, int *low, int &disc_time)
+/* Apply Tarjan's algorithm to find SCCs, from root. The DFS keeps its calls in
+** frames (a vertex is in one at most), not on the process' stack, so that long
+** paths can't overflow it. */
+void Graph::SCC_find_aux(Vertex *head, Stack &st, Vertex root, int *disc, int *low, int &disc_time, Frame *frames)
 {
-	disc[u] = low[u] = ++disc_time;
-	st.push(u);
-
-	std::list<Vertex>::iterator it;
-	for (it = adj[u].begin(); it != adj[u].end(); ++it) {
-		Vertex v = *it;
-
-		/* If v is not visited yet, recur for it */
-		if (disc[v] == 0) {
-			this->SCC_find_aux(head, st, v, disc, low, disc_time);
-			low[u] = min(low[u], low[v]);
-		}
-		/* Update low value of 'u' only if 'v' is still in stack */
-		else if (st.contains(v)) {
-			low[u] = min(low[u], disc[v]);
+	size_t depth = 0;
+
+	disc[root] = low[root] = ++disc_time;
+	st.push(root);
+	frames[0].u = root;
+	frames[0].next = csr.offset[root];
+
+	for (;;) {
+		Vertex u = frames[depth].u;
+
+		if (frames[depth].next < csr.offset[u+1]) {
+			Vertex v = csr.target[frames[depth].next++];
+
+			/* If v is not visited yet, recur for it */
+			if (disc[v] == 0) {
+				disc[v] = low[v] = ++disc_time;
+				st.push(v);
+				depth++;
+				frames[depth].u = v;
+				frames[depth].next = csr.offset[v];
+			}
+			/* Update low value of 'u' only if 'v' is still in stack */
+			else if (st.contains(v)) {
+				low[u] = min(low[u], disc[v]);
+			}
+			continue;
 		}
-	}
 
-	/* head node found, so it's an SCC. Popping stack until we reach head node */
-	if (low[u] == disc[u]) {
-		Stack st_temp(this->nr_vertices+1);
-		Vertex v, root = u;
-
-		st_temp.push(u);
-		while ((v = st.pop()) != u) {
-			root = min(root, v);
-			st_temp.push(v);
+		/* head node found, so it's an SCC: the stack from it up. Finding its
+		** least vertex, then popping stack until we reach head node */
+		if (low[u] == disc[u]) {
+			size_t idx = st.size();
+			Vertex v, min_v = u;
+
+			do {
+				v = st.at(--idx);
+				min_v = min(min_v, v);
+			} while (v != u);
+			while ((v = st.pop()) != u) {
+				head[v] = min_v;
+			}
+			head[u] = min_v;
 		}
-		head[u] = root;
-		while ((v = st_temp.pop()) != u) {
-			head[v] = root;
+
+		/* Returning to u's caller */
+		if (depth == 0) {
+			return;
 		}
+		depth--;
+		low[frames[depth].u] = min(low[frames[depth].u], low[u]);
 	}
 }
 
 void Graph::SCC_find(Graph *scc)
 {
-	int *disc = new int[this->nr_vertices+1];
-	int *low  = new int[this->nr_vertices+1];
-	Vertex *head = new Vertex[this->nr_vertices+1];
+	size_t num_v = this->csr.nr_vertices;
+	int *disc = new int[num_v+1];
+	int *low  = new int[num_v+1];
+	Vertex *head = new Vertex[num_v+1];
 	int disc_time = 0;
-	Stack tarjan(this->nr_vertices+1);
+	Stack tarjan(num_v+1);
+	Frame *frames = new Frame[num_v+1];
 
 	/* Initializing data */
-    for (size_t idx = 0; idx <= this->nr_vertices; idx++) {
+    for (size_t idx = 0; idx <= num_v; idx++) {
 		disc[idx] = 0;
 		low[idx]  = 0;
 		head[idx] = 0;
     }
 
 	/* Performing first DFS with Tarjan */
-	for (Vertex u = vertex_root(); vertex_end(this, u); u = vertex_next(u)) {
+	for (Vertex u = vertex_root(); u <= num_v; u = vertex_next(u)) {
 		if (disc[u] == 0) {
-			this->SCC_find_aux(head, tarjan, u, disc, low, disc_time);
+			this->SCC_find_aux(head, tarjan, u, disc, low, disc_time, frames);
 		}
 	}
 
 	/* Scouring through Graph for SCC connections */
-	for (Vertex u = vertex_root(); vertex_end(this, u); u = vertex_next(u)) {
-		std::list<Vertex>::iterator it;
-		for (it = adj[u].begin(); it != adj[u].end(); ++it) {
-			Vertex v = *it;
+	for (Vertex u = vertex_root(); u <= num_v; u = vertex_next(u)) {
+		for (int e = csr.offset[u]; e < csr.offset[u+1]; e++) {
+			Vertex v = csr.target[e];
 
 			/* Found connection between SCCs */
 			if (head[u] != head[v]) {
-				scc->connect(head[u], head[v]);
+				CSR_Add(&scc->csr, head[u], head[v], 0);
 			}
 		}
 	}
 
+	/* Sorting connections & dropping repeated ones, both in O(V+E) */
+	CSR_SortTargets(&scc->csr);
+	CSR_Build(&scc->csr, true);
+	scc->nr_edges = scc->csr.nr_edges;
+
+	/* Counting the vertices they connect */
+	for (int e = 0; e < scc->csr.nr_edges; e++) {
+		Vertex v = scc->csr.target[e];
+		if (!scc->in_graph[v]) {
+			scc->nr_vertices++;
+			scc->in_graph[v] = true;
+		}
+	}
+	for (Vertex u = vertex_root(); u <= num_v; u = vertex_next(u)) {
+		if (scc->csr.offset[u] < scc->csr.offset[u+1] && !scc->in_graph[u]) {
+			scc->nr_vertices++;
+			scc->in_graph[u] = true;
+		}
+	}
+
 	/* Correcting number of vertices */
 	scc->nr_vertices = max(scc->nr_vertices, 1);
 
@@ -230,6 +242,7 @@ void Graph::SCC_find(Graph *scc)
 	delete [] disc;
 	delete [] low;
 	delete [] head;
+	delete [] frames;
 }
 
 /***************************** MAIN function **********************************/
@@ -237,6 +250,7 @@ int main(void) {
 	size_t num_v, num_e;
 
 	/* Grabbing input */
+	Bench_Phase(BENCH_PARSE);
 	get_number(num_v); /* Grabbing number of vertices */
 	get_number(num_e); /* Grabbing number of edges */
 
@@ -245,9 +259,10 @@ int main(void) {
 	g.init(num_e);
 
 	/* Apply this project's magic */
+	Bench_Phase(BENCH_SOLVE);
 	g.SCC_find(&scc);
-	scc.sort();
-	std::cout << scc;
+	Bench_Phase(BENCH_OUTPUT);
+	scc.print(Output_Stdout());
 
 	return 0;
 }
@@ -8,13 +8,14 @@
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
-#ifdef ASA_BENCHMARK
-#include <time.h>
-#endif
+
+/* Shared libraries */
+#include "CSR.h"
+#include "Bench.h"
 
 /*************************** Auxiliary functions ******************************/
-#define get_number(a)     scanf("%d", a)
-#define get_numbers(a, b) scanf("%d %d", a, b)
+#define get_numbers(a, b) (GraphFile_Read(GF_COUNTS, a), GraphFile_Read(GF_COUNTS, b))
+#define get_weight(id, a) GraphFile_Read(id, a)
 #define max(a, b) (a < b ? b : a)
 #define min(a, b) (a > b ? b : a)
 #define print_spaces(x) printf("%"#x"c", ' ')
@@ -79,10 +80,7 @@ typedef struct graph {
 	int nr_edges;
 
 	/* Graph composition, represented as an Edge array */
-	Edge  *first;   /* first[Pixel] = Edge  */
-	Edge  *last;    /* last[Pixel]  = Edge  */
-	Pixel *pixel;   /* pixel[Edge]  = Pixel */
-	Edge  *next;    /* next[Edge]   = Edge  */
+	CSR csr;        /* csr.target[csr.offset[Pixel] ..] = Pixel */
 
 	/* Network flow data */
 	Pixel s, t; /* s == source, t == sink */
@@ -111,14 +109,10 @@ void graph_new(Graph *g, int m, int n)
 	g->nr_edges = 0; /* Number of edges */
 	g->weight = 0;
 
-	g->first  = calloc((num_v+1), sizeof(g->first));
-	g->last   = calloc((num_v+1), sizeof(g->last));
-	g->pixel  = calloc((num_e+1), sizeof(g->pixel));
-	g->next   = calloc((num_e+1), sizeof(g->next));
+	CSR_New(&g->csr, num_v, num_e, true);
 
 	g->parent   = malloc((num_v+1)* sizeof(g->parent));
-	g->capacity = calloc((num_e+1), sizeof(g->capacity));
-	g->residual = g->capacity;
+	g->capacity = g->residual = NULL; /* Set once the Graph is built */
 
 	g->segments = malloc((num_v)* sizeof(g->segments));
 	memset(g->segments, 'P', (num_v)* sizeof(g->segments));
@@ -126,13 +120,10 @@ void graph_new(Graph *g, int m, int n)
 
 void graph_destroy(Graph *g)
 {
-	free(g->first);    g->first    = NULL;
-	free(g->last);     g->last     = NULL;
-	free(g->pixel);    g->pixel    = NULL;
-	free(g->next);     g->next     = NULL;
+	CSR_Destroy(&g->csr);
+	g->capacity = g->residual = NULL;
 
 	free(g->parent);   g->parent   = NULL;
-	free(g->capacity); g->capacity = NULL;
 
 	free(g->segments); g->segments = NULL;
 }
@@ -142,31 +133,20 @@ Pixel graph_get_pixel(Graph *g, int i, int j) { return (i-1)*g->n + j; }
 Pixel graph_h_neighbor(Graph *g, Pixel u) { return u+1; }
 Pixel graph_v_neighbor(Graph *g, Pixel u) { return u+g->n; }
 
-/* Returns the index of the connection between two Pixels. 0 if not found. */
+/* Returns the index of the connection between two Pixels. NIL if not found. */
 Edge graph_get_edge(Graph *g, Pixel u, Pixel v)
 {
 	Edge adj; /* O(1) : Takes (4 pixel neighbors) amount of time */
-	for (adj = g->first[u]; adj != 0 && g->pixel[adj] != v; adj = g->next[adj]);
-	return adj;
+	for (adj = g->csr.offset[u]; adj < g->csr.offset[u+1]; adj++) {
+		if (g->csr.target[adj] == v) { return adj; }
+	}
+	return NIL;
 }
 
-/* Adds/Removes weight between two Pixels */
-Edge graph_connect(Graph *g, Pixel u, Pixel v, int weight)
+/* Adds weight between two Pixels. Edges are laid out once the Graph is built. */
+void graph_connect(Graph *g, Pixel u, Pixel v, int weight)
 {
-	Edge e = ++g->nr_edges;
-
-	g->pixel[e] = v;
-	g->capacity[e] = weight;
-
-	if (g->first[u] == 0) {
-		g->first[u] = e;
-	} else {
-		Edge adj = g->last[u];
-		g->next[adj] = e;
-	}
-	g->last[u] = e;
-
-	return e;
+	CSR_Add(&g->csr, u, v, weight);
 }
 
 /* Initializes Graph with input data */
@@ -178,13 +158,13 @@ void graph_init(Graph *g)
 
 	/* Grabbing each Pixel L weight */
 	for (u = 1; u < g->nr_vertices; u++) {
-		get_number(&weight_l[u]);
+		get_weight(GF_PIXEL_L, &weight_l[u]);
 	}
 
 	/* Grabbing each Pixel C weight */
 	for (u = 1; u < g->nr_vertices; u++) {
 		int l = weight_l[u], c;
-		get_number(&c);
+		get_weight(GF_PIXEL_C, &c);
 
 		/* To avoid additional BFS cycles, we're creating only the necessary edges
 		* by connecting the edges with the minimum weight.
@@ -205,7 +185,7 @@ void graph_init(Graph *g)
 			u = graph_get_pixel(g, i, j);
 			v = graph_h_neighbor(g, u);
 
-			get_number(&w);
+			get_weight(GF_PIXEL_H, &w);
 			if (w > 0) {
 				graph_connect(g, u, v, w);
 				graph_connect(g, v, u, w);
@@ -219,18 +199,25 @@ void graph_init(Graph *g)
 			u = graph_get_pixel(g, i, j);
 			v = graph_v_neighbor(g, u);
 
-			get_number(&w);
+			get_weight(GF_PIXEL_V, &w);
 			if (w > 0) {
 				graph_connect(g, u, v, w);
 				graph_connect(g, v, u, w);
 			}
 		}
 	}
+
+	/* Laying adjacencies out contiguously */
+	Bench_Phase(BENCH_BUILD);
+	CSR_Build(&g->csr, false);
+	g->nr_edges = g->csr.nr_edges;
+	g->capacity = g->residual = g->csr.weight;
 }
 
 /* Graph weight gathering  */
 int graph_get_f_weight(Graph *g, Pixel u, Pixel v) {
-	return g->capacity[graph_get_edge(g, u, v)];
+	Edge adj = graph_get_edge(g, u, v);
+	return adj != NIL ? g->capacity[adj] : 0;
 }
 int graph_get_l_weight(Graph *g, Pixel u) { return graph_get_f_weight(g, g->s, u); }
 int graph_get_c_weight(Graph *g, Pixel u) { return graph_get_f_weight(g, u, g->t); }
@@ -311,14 +298,16 @@ bool bfs(Graph *g, Queue *q, int *df)
 
 	/* Synchronizing queues */
 	queue_push(q, g->s);
+	Bench_Count(BENCH_BFS_PASSES);
 
 	/* O(V+E) : Scouring Graph. */
 	while (!queue_is_empty(q)) {
 		Edge adj;
         Pixel u = queue_pop(q);
 
-        for (adj = g->first[u]; adj != 0; adj = g->next[adj]) {
-            Pixel v = g->pixel[adj];
+        Bench_Add(BENCH_EDGES_SCANNED, g->csr.offset[u+1] - g->csr.offset[u]);
+        for (adj = g->csr.offset[u]; adj < g->csr.offset[u+1]; adj++) {
+            Pixel v = g->csr.target[adj];
 			int cf = g->residual[adj];
 
             if (g->parent[v] == NIL && cf > 0) {
@@ -339,19 +328,10 @@ int edmonds_karp(Graph *g)
 	Pixel u, v;
 	Queue q;
 
-	#ifdef ASA_BENCHMARK
-	int count = 0;
-	clock_t start = 0, end = 0;
-	float secs;
-	#endif
-
 	/* Initializing data */
 	queue_new(&q, g->nr_vertices+1, false);
 
 	/* Applying algorithm */
-	#ifdef ASA_BENCHMARK
-	start = clock();
-	#endif
 	while (bfs(g, &q, &df)) {
 		/* We found an augmenting path. See how much flow we can send */
 		Edge adj;
@@ -363,20 +343,13 @@ int edmonds_karp(Graph *g)
 			g->residual[adj] -= df;
 
 			adj = graph_get_edge(g, v, u);
-			g->residual[adj] += df;
+			if (adj != NIL) { g->residual[adj] += df; }
 		}
 
 		flow += df;
 		df = INF;
-		#ifdef ASA_BENCHMARK
-		count++;
-		#endif
+		Bench_Count(BENCH_AUGMENTING_PATHS);
 	}
-	#ifdef ASA_BENCHMARK
-	end = clock();
-	secs = (float)(end - start) / CLOCKS_PER_SEC;
-	fprintf(stderr, "BFS: %.2lf seconds.\n", secs);
-	#endif
 
 	/* Checking for network cuts */
 	for (u = 1; u < g->nr_vertices; u++) {
@@ -393,21 +366,8 @@ int edmonds_karp(Graph *g)
 
 void update_weights(Graph *g)
 {
-	#ifdef ASA_BENCHMARK
-	clock_t start, end;
-	float secs;
-
-	start = clock();
-	#endif
 	/* Using Edmonds-Karp algorithm */
 	g->weight += edmonds_karp(g);
-
-	#ifdef ASA_BENCHMARK
-	end = clock();
-
-	secs = (float)(end - start) / CLOCKS_PER_SEC;
-	// fprintf(stderr, "Algorithm: %.2lf seconds.\n", secs);
-	#endif
 }
 
 #undef NIL
@@ -419,6 +379,7 @@ int main(void) {
 	Graph g;
 
 	/* Grabbing dimensions of our Graph from input */
+	Bench_Phase(BENCH_PARSE);
 	get_numbers(&m, &n);
 
 	/* Instancing graphs */
@@ -426,9 +387,11 @@ int main(void) {
 	graph_init(&g); /* Initializing Graph from input */
 
 	/* Apply this project's magic */
+	Bench_Phase(BENCH_SOLVE);
 	update_weights(&g);
 
 	/* Printing required output */
+	Bench_Phase(BENCH_OUTPUT);
 	printf("%d\n\n", graph_get_weight(&g));
 	graph_print_segments(&g);
 
@@ -7,13 +7,15 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#ifdef ASA_BENCHMARK
-#include <time.h>
-#endif
+
+/* Shared libraries */
+#include "CSR.h"
+#include "Output.h"
+#include "Bench.h"
 
 /*************************** Auxiliary functions ******************************/
-#define get_number(a)     scanf("%d", a)
-#define get_numbers(a, b) scanf("%d %d", a, b)
+#define get_number(a)     GraphFile_Read(GF_COUNTS, a)
+#define get_edge(a, b)    GraphFile_ReadEdge(a, b)
 #define max(a, b) (a < b ? b : a)
 #define min(a, b) (a > b ? b : a)
 
@@ -98,37 +100,21 @@ typedef struct graph {
 	int nr_edges;
 	bool is_bidir;
 
-	/* Graph composition, represented as an Edge array */
-	Edge   *first;    /* first[Vertex] = Edge   */
-	Vertex *vertex;   /* vertex[Edge]  = Vertex */
-	Edge   *next;     /* next[Edge]    = Edge   */
+	/* Graph composition, as a compressed sparse row */
+	CSR csr;          /* csr.target[csr.offset[Vertex] ..] = Vertex */
 
 	/* Other data */
 	Vertex *parent;
 
 } Graph;
 
-/* Connects two Vertices */
+/* Connects two Vertices. Repeated Edges are dropped once the Graph is built. */
 void graph_connect(Graph *g, Vertex u, Vertex v, bool undirected)
 {
-	g->nr_edges++;
-	g->vertex[g->nr_edges] = v;
-
-	if (g->first[u] == 0) {
-		g->first[u] = g->nr_edges;
-	} else {
-		Edge adj;
-		for (adj = g->first[u]; g->next[adj] != 0 && g->vertex[adj] != v; adj = g->next[adj]);
-		/* if Vertex v is already in here, stop everything */
-		if (g->vertex[adj] == v) {
-			g->vertex[g->nr_edges--] = 0;
-			return;
-		}
-		g->next[adj] = g->nr_edges;
-	}
+	CSR_Add(&g->csr, u, v, 0);
 
 	if (undirected) { /* Add reverse Edge */
-		graph_connect(g, v, u, false);
+		CSR_Add(&g->csr, v, u, 0);
 	}
 }
 
@@ -143,9 +129,7 @@ void graph_new(Graph *g, int num_v, int num_e, bool is_bidir)
 		num_e *= 2;
 	}
 
-	g->first  = calloc((num_v+1), sizeof(*g->first));
-	g->vertex = calloc((num_e+1), sizeof(*g->vertex));
-	g->next   = calloc((num_e+1), sizeof(*g->next));
+	CSR_New(&g->csr, num_v, num_e, false);
 
 	g->parent = calloc((num_v+1), sizeof(*g->parent));
 }
@@ -158,28 +142,30 @@ void graph_init(Graph *g, int num_e)
 		Vertex u, v;
 
 		/* Grab two numbers from input & convert them to Vertex */
-		get_numbers(&num1, &num2);
+		get_edge(&num1, &num2);
 		u = vertex_new(num1);
 		v = vertex_new(num2);
 		/* Connect them to the graph */
 		graph_connect(g, u, v, g->is_bidir);
 	}
+
+	/* Laying adjacencies out contiguously */
+	Bench_Phase(BENCH_BUILD);
+	CSR_Build(&g->csr, true);
+	g->nr_edges = g->csr.nr_edges;
 }
 
 void graph_reset(Graph *g)
 {
-	memset(g->first,  0, (g->nr_vertices+1) * sizeof(*g->first));
-	memset(g->vertex, 0, (g->nr_edges+1)    * sizeof(*g->vertex));
-	memset(g->next,   0, (g->nr_edges+1)    * sizeof(*g->next));
+	CSR_Destroy(&g->csr);
+	CSR_New(&g->csr, g->nr_vertices, g->nr_edges, false);
 	memset(g->parent, 0, (g->nr_vertices+1) * sizeof(*g->parent));
 	g->nr_edges = 0;
 }
 
 void graph_destroy(Graph *g)
 {
-	free(g->first);   g->first      = NULL;
-	free(g->vertex);  g->vertex     = NULL;
-	free(g->next);    g->next       = NULL;
+	CSR_Destroy(&g->csr);
 	free(g->parent);  g->parent     = NULL;
 }
 
@@ -205,22 +191,24 @@ void SCC_destroy(SCC_data *scc)
 
 void SCC_print(SCC_data *scc)
 {
+	Output *out = Output_Stdout();
+
 	/* Print number of SCCs */
-	printf("%d\n", stack_size(&scc->ids));
+	Output_Int(out, stack_size(&scc->ids)); Output_Char(out, '\n');
 
 	/* Print all last nodes found in SCC */
 	while (!stack_is_empty(&scc->ids)) {
 		Vertex u = stack_pop(&scc->ids);
-		printf("%d", u);
-		if (!stack_is_empty(&scc->ids)) { printf(" "); }
+		Output_Int(out, u);
+		if (!stack_is_empty(&scc->ids)) { Output_Char(out, ' '); }
 	}
-	printf("\n");
+	Output_Char(out, '\n');
 
 	/* Print number of nodes that, when removed, create more SCCs */
-	printf("%d\n", stack_size(&scc->ap));
+	Output_Int(out, stack_size(&scc->ap)); Output_Char(out, '\n');
 
 	/* Print the biggest SCC's node count */
-	printf("%d\n", scc->biggest_scc);
+	Output_Int(out, scc->biggest_scc); Output_Char(out, '\n');
 }
 
 /* Runs DFS through graph whilst ignoring Articulation Points */
@@ -234,11 +222,13 @@ void count_scc(
 
 	if (stack_contains(&scc->ap, u)) { return; }
 
+	Bench_Enter();
 	disc[u] = low[u] = ++(*disc_time);
 	stack_push(st, u);
 
-	for (adj = g->first[u]; adj != 0; adj = g->next[adj]) {
-		Vertex v = g->vertex[adj];
+	Bench_Add(BENCH_EDGES_SCANNED, g->csr.offset[u+1] - g->csr.offset[u]);
+	for (adj = g->csr.offset[u]; adj < g->csr.offset[u+1]; adj++) {
+		Vertex v = g->csr.target[adj];
 
 		if (stack_contains(&scc->ap, v)) { continue; }
 
@@ -259,6 +249,7 @@ void count_scc(
 		scc->biggest_scc = max(scc->biggest_scc, stack_size(st));
 		while ((v = stack_pop(st)) != u);
 	}
+	Bench_Leave();
 }
 
 /* Apply Tarjan's algorithm to find SCCs */
@@ -271,11 +262,13 @@ void tarjan_aux(
 	Edge adj;
 	int children = 0;
 
+	Bench_Enter();
 	disc[u] = low[u] = ++(*disc_time);
 	stack_push(st, u);
 
-	for (adj = g->first[u]; adj != 0; adj = g->next[adj]) {
-		Vertex v = g->vertex[adj];
+	Bench_Add(BENCH_EDGES_SCANNED, g->csr.offset[u+1] - g->csr.offset[u]);
+	for (adj = g->csr.offset[u]; adj < g->csr.offset[u+1]; adj++) {
+		Vertex v = g->csr.target[adj];
 
 		/* If v is not visited yet, recur for it */
 		if (disc[v] == 0) {
@@ -305,6 +298,7 @@ void tarjan_aux(
 		}
 		stack_push(&scc->ids, tail);
 	}
+	Bench_Leave();
 }
 
 void tarjan(Graph *g, SCC_data *scc)
@@ -345,42 +339,12 @@ void tarjan(Graph *g, SCC_data *scc)
 void graph_find_SCCs(Graph *g)
 {
 	SCC_data scc;
-		#ifdef ASA_BENCHMARK
-		clock_t start, end;
-		float secs;
-
-		start = clock();
-		#endif
 
 	SCC_new(&scc, g->nr_vertices+1);
-
-		#ifdef ASA_BENCHMARK
-		end = clock();
-		secs = (float)(end - start) / CLOCKS_PER_SEC;
-		fprintf(stderr, "Creation: %.6lf seconds.\n", secs);
-		#endif
-
-		#ifdef ASA_BENCHMARK
-		start = clock();
-		#endif
 	tarjan(g, &scc);
-		#ifdef ASA_BENCHMARK
-		end = clock();
-		secs = (float)(end - start) / CLOCKS_PER_SEC;
-		fprintf(stderr, "Algorithm: %.6lf seconds.\n", secs);
-		#endif
-
-		#ifdef ASA_BENCHMARK
-		start = clock();
-		#endif
 	stack_sort(&scc.ids); /* This adds one more to the complexity */
-		#ifdef ASA_BENCHMARK
-		end = clock();
-		secs = (float)(end - start) / CLOCKS_PER_SEC;
-		fprintf(stderr, "Sorting: %.6lf seconds.\n", secs);
-		fprintf(stderr, "\n");
-		#endif
 
+	Bench_Phase(BENCH_OUTPUT);
 	SCC_print(&scc);
 
 	SCC_destroy(&scc);
@@ -392,6 +356,7 @@ int main(void) {
 	Graph g;
 
 	/* Grabbing input */
+	Bench_Phase(BENCH_PARSE);
 	get_number(&num_v); /* Grabbing number of vertices */
 	get_number(&num_e); /* Grabbing number of edges */
 
@@ -400,6 +365,7 @@ int main(void) {
 	graph_init(&g, num_e);
 
 	/* Apply this project's magic */
+	Bench_Phase(BENCH_SOLVE);
 	graph_find_SCCs(&g);
 
 	/* Freeing data */
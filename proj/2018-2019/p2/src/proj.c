@@ -11,12 +11,17 @@
 #include <time.h>
 #endif
 
+/* Shared libraries */
+#include "GraphFile.h"
+#include "Output.h"
+#include "Bench.h"
+
 /*************************** Auxiliary functions ******************************/
 #define max(a, b) (a < b ? b : a)
 #define min(a, b) (a > b ? b : a)
-#define get_number(a) scanf("%d", a)
-#define get_2_numbers(a, b) scanf("%d %d", a, b)
-#define get_3_numbers(a, b, c) scanf("%d %d %d", a, b, c)
+#define get_weight(id, a) GraphFile_Read(id, a)
+#define get_edge(a, b, w) GraphFile_ReadWeightedEdge(a, b, w)
+#define get_3_numbers(a, b, c) (get_weight(GF_COUNTS, a), get_weight(GF_COUNTS, b), get_weight(GF_COUNTS, c))
 
 /*************************** Fake boolean structure ****************************/
 typedef unsigned char bool;
@@ -151,12 +156,10 @@ Edge graph_connect(Graph *g, Vertex u, Vertex v)
 }
 
 /* Adds weighted Edge to Graph */
-void graph_add_edge(Graph *g, Vertex u, Vertex v)
+void graph_add_edge(Graph *g, Vertex u, Vertex v, int capacity)
 {
-	int num;
 	Edge e = graph_connect(g, u, v);
-	get_number(&num);
-	g->capacity[e] = num;
+	g->capacity[e] = capacity;
 	g->prev[e] = graph_connect(g, v, u);
 	g->prev[g->prev[e]] = e;
 }
@@ -184,15 +187,15 @@ void graph_new(Graph *g, int num_v, int num_e)
 void graph_init(Graph *g, int num_e)
 {
 	while (num_e-- > 0) {
-		int num1, num2;
+		int num1, num2, num;
 		Vertex u, v;
 
-		/* Grab two numbers from input & convert them to Vertex */
-		get_2_numbers(&num1, &num2);
+		/* Grab two numbers & a capacity from input & convert them to Vertex */
+		get_edge(&num1, &num2, &num);
 		u = vertex_new(num1);
 		v = vertex_new(num2);
 
-		graph_add_edge(g, u, v);
+		graph_add_edge(g, u, v, num);
 	}
 }
 
@@ -203,7 +206,9 @@ void graph_add_sources(Graph *g, int vertices, Vertex v)
 
 	/* Adding Vertex capacity */
 	for (i = 0, v = vertex_next(v); i < vertices; v = vertex_next(v), i++) {
-		graph_add_edge(g, u, v);
+		int num;
+		get_weight(GF_CAPACITIES, &num);
+		graph_add_edge(g, u, v, num);
 	}
 }
 
@@ -213,7 +218,7 @@ void graph_add_stops(Graph *g, int vertices, Vertex v)
 
 	for (i = 0, v = vertex_next(v); i < vertices; v = vertex_next(v), i++) {
 		int num;
-		get_number(&num);
+		get_weight(GF_MINIMUMS, &num);
 		g->v_minimum[v] = num;
 	}
 }
@@ -276,18 +281,19 @@ void maxflow_output(MaxFlow *mf, Graph *g)
 {
 	int i, size;
 	Vertex *edges[2];
+	Output *out = Output_Stdout();
 
 	/* Printing Max Flow */
-	printf("%d\n", mf->value);
+	Output_Int(out, mf->value); Output_Char(out, '\n');
 
 	/* Printing Stations in need of augmenting */
 	size = queue_size(mf->stations);
 	queue_sort(mf->stations);
 	for (i = 0; i < size; i++) {
 		Vertex u = queue_pop(mf->stations);
-		printf("%d", u);
-		if (i+1 < size) printf(" ");
-	} printf("\n");
+		Output_Int(out, u);
+		if (i+1 < size) Output_Char(out, ' ');
+	} Output_Char(out, '\n');
 
 	/* Printing Edges in need of augmenting (closest to sink) */
 	size = queue_size(mf->edges);
@@ -311,7 +317,8 @@ void maxflow_output(MaxFlow *mf, Graph *g)
 			v = edges[1][i];
 
 		if (u == source) continue;
-		printf("%d %d\n", u, v);
+		Output_Int(out, u); Output_Char(out, ' ');
+		Output_Int(out, v); Output_Char(out, '\n');
 	}
 
 	free(edges[0]); free(edges[1]);
@@ -450,7 +457,9 @@ void apply(Graph *g)
 	MaxFlow mf;
 
 	maxflow_new(&mf, g);
+	Bench_Phase(BENCH_SOLVE);
 	dinic(g, &mf); /* Summoning algorithm Dinic, O(E V^2) */
+	Bench_Phase(BENCH_OUTPUT);
 	maxflow_output(&mf, g);
 	maxflow_destroy(&mf);
 }
@@ -461,6 +470,7 @@ int main(void) {
 	Graph g;
 
 	/* Grabbing Graph's main data */
+	Bench_Phase(BENCH_PARSE);
 	get_3_numbers(&f, &e, &t);
 
 	/* Instancing Graph from input */
@@ -6,9 +6,13 @@
 #include <time.h>
 #endif
 
+/* Shared libraries */
+#include "CSR.h"
+#include "Bench.h"
+
 /*************************** Auxiliary functions ******************************/
-#define get_number(a)     scanf("%d", a)
-#define get_numbers(a, b) scanf("%d %d", a, b)
+#define get_number(a)     GraphFile_Read(GF_COUNTS, a)
+#define get_edge(a, b)    GraphFile_ReadEdge(a, b)
 #define max(a, b) (a < b ? b : a)
 #define min(a, b) (a > b ? b : a)
 
@@ -87,37 +91,21 @@ typedef struct graph {
 	int nr_vertices, nr_edges;
 	bool is_bidir;
 
-	/* Graph composition, represented as an Edge array */
-	Edge   *first;    /* first[Vertex] = Edge   */
-	Vertex *vertex;   /* vertex[Edge]  = Vertex */
-	Edge   *next;     /* next[Edge]    = Edge   */
+	/* Graph composition, as a compressed sparse row */
+	CSR csr;          /* csr.target[csr.offset[Vertex] ..] = Vertex */
 
 	/* Other data */
 	int longest_path, nr_paths;
 
 } Graph;
 
-/* Connects two Vertices */
+/* Connects two Vertices. Repeated Edges are dropped once the Graph is built. */
 void Graph_Connect(Graph *g, Vertex u, Vertex v, bool undirected)
 {
-	g->nr_edges++;
-	g->vertex[g->nr_edges] = v;
-
-	if (g->first[u] == 0) {
-		g->first[u] = g->nr_edges;
-	} else {
-		Edge adj;
-		for (adj = g->first[u]; g->next[adj] != 0 && g->vertex[adj] != v; adj = g->next[adj]);
-		/* if Vertex v is already in here, stop everything */
-		if (g->vertex[adj] == v) {
-			g->vertex[g->nr_edges--] = 0;
-			return;
-		}
-		g->next[adj] = g->nr_edges;
-	}
+	CSR_Add(&g->csr, u, v, 0);
 
 	if (undirected) { /* Add reverse Edge */
-		Graph_Connect(g, v, u, false);
+		CSR_Add(&g->csr, v, u, 0);
 	}
 }
 
@@ -134,32 +122,40 @@ void Graph_New(Graph *g, int num_v, int num_e, bool is_bidir)
 		num_e *= 2;
 	}
 
-	g->first  = calloc((num_v+1), sizeof(*g->first));
-	g->vertex = calloc((num_e+1), sizeof(*g->vertex));
-	g->next   = calloc((num_e+1), sizeof(*g->next));
+	CSR_New(&g->csr, num_v, num_e, false);
 }
 
 /* Initializes Graph with input data */
 void Graph_Init(Graph *g, int num_e)
 {
+	/* Binary graph files are used in place */
+	if (GraphFile_Stdin() && !g->is_bidir && CSR_FromFile(&g->csr, GraphFile_Stdin(), true)) {
+		g->nr_edges = g->csr.nr_edges;
+		return;
+	}
+
 	while (num_e-- > 0) {
 		int num1, num2;
 		Vertex u, v;
 
 		/* Grab two numbers from input & convert them to Vertex */
-		get_numbers(&num1, &num2);
+		get_edge(&num1, &num2);
 		u = vertex_new(num1);
 		v = vertex_new(num2);
 		/* Connect them to the graph */
 		Graph_Connect(g, u, v, g->is_bidir);
 	}
+
+	/* Laying adjacencies out contiguously */
+	Bench_Phase(BENCH_BUILD);
+	CSR_Build(&g->csr, true);
+	g->nr_edges = g->csr.nr_edges;
 }
 
 void Graph_Reset(Graph *g)
 {
-	memset(g->first,  0, (g->nr_vertices+1) * sizeof(*g->first));
-	memset(g->vertex, 0, (g->nr_edges+1)    * sizeof(*g->vertex));
-	memset(g->next,   0, (g->nr_edges+1)    * sizeof(*g->next));
+	CSR_Destroy(&g->csr);
+	CSR_New(&g->csr, g->nr_vertices, g->nr_edges, false);
 	g->nr_edges = 0;
 }
 
@@ -168,8 +164,8 @@ void Graph_Print(Graph *g)
 	int u;
 	for (u = 1; u <= g->nr_vertices; u++) {
 		int adj;
-		for (adj = g->first[u]; adj != 0; adj = g->next[adj]) {
-			int v = g->vertex[adj];
+		for (adj = g->csr.offset[u]; adj < g->csr.offset[u+1]; adj++) {
+			int v = g->csr.target[adj];
 			printf("%d %d\n", u, v);
 		}
 	}
@@ -177,9 +173,7 @@ void Graph_Print(Graph *g)
 
 void Graph_Destroy(Graph *g)
 {
-	free(g->first);   g->first      = NULL;
-	free(g->vertex);  g->vertex     = NULL;
-	free(g->next);    g->next       = NULL;
+	CSR_Destroy(&g->csr);
 }
 
 /****************************** Topologic *******************************/
@@ -189,8 +183,8 @@ void DP(Graph *g, Stack *order, int *dist)
 		int adj;
 		int u = Stack_Pop(order);
 
-		for (adj = g->first[u]; adj != 0; adj = g->next[adj]) {
-			int v = g->vertex[adj];
+		for (adj = g->csr.offset[u]; adj < g->csr.offset[u+1]; adj++) {
+			int v = g->csr.target[adj];
 			dist[v] = dist[u] + 1;
 		}
 	}
@@ -223,8 +217,8 @@ void DFS(Graph *g, Stack *order, bool *visited)
 			Stack_Push(&dfs, u);
 			is_last[u] = true;
 
-			for (adj = g->first[u]; adj != 0; adj = g->next[adj]) {
-				int v = g->vertex[adj];
+			for (adj = g->csr.offset[u]; adj < g->csr.offset[u+1]; adj++) {
+				int v = g->csr.target[adj];
 				if (!visited[v]) {
 					Stack_Push(&dfs, v);
 					is_last[v] = false;
@@ -267,6 +261,7 @@ int main(void) {
 	Graph g;
 
 	/* Grabbing input */
+	Bench_Phase(BENCH_PARSE);
 	get_number(&num_v); /* Grabbing number of vertices */
 	get_number(&num_e); /* Grabbing number of edges */
 
@@ -275,9 +270,11 @@ int main(void) {
 	Graph_Init(&g, num_e);
 
 	/* Apply this project's magic */
+	Bench_Phase(BENCH_SOLVE);
 	TopologicalSort(&g);
 
 	/* Outputing solution */
+	Bench_Phase(BENCH_OUTPUT);
 	printf("%d %d\n", g.nr_paths, g.longest_path);
 
 	/* Freeing data */
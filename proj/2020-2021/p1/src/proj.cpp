@@ -1,15 +1,17 @@
 #include <iostream>
 #include <vector>
-#include <list>
 #include <stack>
 
 #include <stdio.h>
 
+#include "ParallelInput.h"
+#include "Bench.h"
+
 using namespace std;
 
 class Graph {
 	bool is_bidir;
-	list<int> *adj;
+	CSR csr; /* csr.target[csr.offset[u] ..] = v */
 
 public:
 	int nr_vertices, nr_edges;
@@ -17,7 +19,7 @@ public:
 
 	Graph(bool is_bidir);
 	~Graph() {
-		delete[] adj;
+		CSR_Destroy(&csr);
 	}
 	void Connect(int u, int v);
 	void DFS(vector<int> &order);
@@ -26,15 +28,28 @@ public:
 
 	/* stdin overloader; builds the Graph */
 	friend istream& operator>>(istream &is, Graph &g) {
-		/* scanf() is faster than >> */
-		scanf("%d %d", &g.nr_vertices, &g.nr_edges);
-		g.adj = new list<int>[g.nr_vertices+1];
-
-		for (int i = 0; i < g.nr_edges; i++) {
-			int u, v;
-			scanf("%d %d", &u, &v);
-			g.Connect(u, v);
+		/* Input is faster than both scanf() and >>; binary graph files skip parsing */
+		GraphFile_Read(GF_COUNTS, &g.nr_vertices);
+		GraphFile_Read(GF_COUNTS, &g.nr_edges);
+		CSR_New(&g.csr, g.nr_vertices, g.is_bidir ? 2*g.nr_edges : g.nr_edges, false);
+
+		/* Binary graph files are used in place */
+		if (GraphFile_Stdin() && !g.is_bidir && CSR_FromFile(&g.csr, GraphFile_Stdin(), false)) {
+			return is;
+		}
+
+		if (GraphFile_Stdin()) {
+			for (int i = 0; i < g.nr_edges; i++) {
+				int u, v;
+				GraphFile_ReadEdge(&u, &v);
+				g.Connect(u, v);
+			}
+		} else {
+			/* Text edges are parsed on every core */
+			Input_ParallelEdges(Input_Stdin(), g.nr_edges, &g.csr, g.is_bidir);
 		}
+		Bench_Phase(BENCH_BUILD);
+		CSR_Build(&g.csr, false);
 
 		return is;
 	}
@@ -44,8 +59,8 @@ public:
 		os << g.nr_vertices << " " << g.nr_edges << endl;
 		for (int u = 1; u <= g.nr_vertices; u++) {
 			os << u;
-			for (list<int>::const_iterator it = g.adj[u].begin(); it != g.adj[u].end(); ++it) {
-				int v = *it;
+			for (int adj = g.csr.offset[u]; adj < g.csr.offset[u+1]; adj++) {
+				int v = g.csr.target[adj];
 				os << " " << v;
 			}
 			os << endl;
@@ -58,13 +73,14 @@ Graph::Graph(bool is_bidirectional)
 {
 	this->is_bidir = is_bidirectional;
 	this->longest_path = this->nr_paths = 0;
+	CSR_New(&this->csr, 0, 0, false);
 }
 
 void Graph::Connect(int u, int v)
 {
-	adj[u].push_back(v);
+	CSR_Add(&csr, u, v, 0);
 	if (this->is_bidir) {
-		adj[v].push_back(u);
+		CSR_Add(&csr, v, u, 0);
 	}
 }
 
@@ -75,8 +91,8 @@ void Graph::DP(vector<int> &order, vector<int> &dist)
 	// for (size_t idx = 0; idx < order.size(); idx++) {
 		int u = order[idx];
 
-		for (list<int>::iterator it = adj[u].begin(); it != adj[u].end(); it++) {
-			int v = *it;
+		for (int adj = csr.offset[u]; adj < csr.offset[u+1]; adj++) {
+			int v = csr.target[adj];
 			dist[v] = dist[u] + 1;
 		}
 	}
@@ -107,8 +123,8 @@ void Graph::DFS(vector<int> &order)
 			dfs.push(u);
 			is_last[u] = true;
 
-			for (list<int>::iterator it = adj[u].begin(); it != adj[u].end(); it++) {
-				int v = *it;
+			for (int adj = csr.offset[u]; adj < csr.offset[u+1]; adj++) {
+				int v = csr.target[adj];
 				if (!visited[v]) {
 					dfs.push(v);
 					is_last[v] = false;
@@ -138,12 +154,15 @@ int main()
 	Graph g(false);
 
 	/* Grabbing input */
+	Bench_Phase(BENCH_PARSE);
 	cin >> g;
 
 	/* Apply this project's magic */
+	Bench_Phase(BENCH_SOLVE);
 	g.TopologicalSort();
 
 	/* Outputing solution */
+	Bench_Phase(BENCH_OUTPUT);
 	cout << g.nr_paths << " " << g.longest_path << endl;
 
 	return 0;
@@ -6,6 +6,9 @@
 #include <limits.h>
 #include <string.h>
 
+#include "GraphFile.h"
+#include "Bench.h"
+
 using namespace std;
 
 #define SOURCE 0
@@ -59,8 +62,9 @@ public:
 
 	/* stdin overloader; builds the Graph */
 	friend istream& operator>>(istream &is, Graph &g) {
-		/* scanf() is faster than >> */
-		scanf("%d %d", &g.N, &g.K);
+		/* Input is faster than both scanf() and >>; binary graph files skip parsing */
+		GraphFile_Read(GF_COUNTS, &g.N);
+		GraphFile_Read(GF_COUNTS, &g.K);
 
 		g.nr_vertices = g.N+2;
 		g.nr_edges = 0;
@@ -85,7 +89,8 @@ public:
 		/* Connecting vertices to source & sink */
 		for (int u = 1; u <= g.N; u++) {
 			int w_xu, w_uy;
-			scanf("%d %d", &w_xu, &w_uy);
+			GraphFile_Read(GF_COST_X, &w_xu);
+			GraphFile_Read(GF_COST_Y, &w_uy);
 			g.Connect(SOURCE, u, w_xu);
 			g.Connect(u, g.N+1, w_uy);
 		}
@@ -93,7 +98,7 @@ public:
 		/* Connecting vertices between each other */
 		for (int idx = 0; idx < g.K; idx++) {
 			int u, v, w;
-			scanf("%d %d %d", &u, &v, &w);
+			GraphFile_ReadWeightedEdge(&u, &v, &w);
 			g.Connect(u, v, w);
 		}
 
@@ -251,10 +256,15 @@ int main()
 	Graph g;
 
 	/* Grabbing input */
+	Bench_Phase(BENCH_PARSE);
 	cin >> g;
 
 	/* Apply this project's magic */
-	cout << g.GetMaxFlow() << endl;
+	Bench_Phase(BENCH_SOLVE);
+	int max_flow = g.GetMaxFlow();
+
+	Bench_Phase(BENCH_OUTPUT);
+	cout << max_flow << endl;
 
 	return 0;
 }